@@ -89,6 +89,34 @@
 #define cute_fail(_reason) \
 	_cute_fail(_reason, __FILE__, __LINE__, __func__)
 
+/**
+ * Exclude a heap block from leak detection.
+ *
+ * @param[in] ptr address of heap block to exclude
+ *
+ * When heap allocations are tracked (see cute_config::heap), stop
+ * considering the block pointed to by @p ptr as owned by the
+ * @rstsubst{test case} that allocated it so that it is not reported as left
+ * allocated once the test completes. This is meant for caches the code under
+ * test keeps allocated on purpose for the lifetime of the process.
+ *
+ * Has no effect when heap allocations are not tracked or when @p ptr was
+ * allocated before tracking started.
+ *
+ * **Example**
+ * @code{.c}
+ * CUTE_TEST(cache_test)
+ * {
+ *      const struct cache * cache = cache_get();
+ *
+ *      cute_heap_ignore(cache);
+ *      ...
+ * }
+ * @endcode
+ */
+extern void
+cute_heap_ignore(const void * ptr) __cute_export;
+
 /******************************************************************************
  * Common definitions
  ******************************************************************************/
@@ -142,6 +170,7 @@
  * @see
  * - #CUTE_INHR_TMOUT
  * - #CUTE_NONE_TMOUT
+ * - #CUTE_MSEC_TMOUT
  */
 #define CUTE_DFLT_TMOUT (3U)
 
@@ -169,9 +198,31 @@
  * @see
  * - #CUTE_DFLT_TMOUT
  * - #CUTE_INHR_TMOUT
+ * - #CUTE_MSEC_TMOUT
  */
 #define CUTE_NONE_TMOUT (0U)
 
+/**
+ * Millisecond test timeout.
+ *
+ * @param[in] _msec timeout expressed in milliseconds
+ *
+ * When defining a test or suite, use this to specify a @rstsubst{timeout}
+ * with a finer resolution than plain unsigned integers which are expressed in
+ * seconds.
+ *
+ * @p _msec must be lower than 2^30. A zero @p _msec disables the timeout
+ * mechanism the same way #CUTE_NONE_TMOUT does.
+ *
+ * @see
+ * - #CUTE_DFLT_TMOUT
+ * - #CUTE_INHR_TMOUT
+ * - #CUTE_NONE_TMOUT
+ */
+#define CUTE_MSEC_TMOUT(_msec) \
+	((_msec) ? (CUTE_MSEC_TMOUT_FLAG | (unsigned int)(_msec)) : \
+	           CUTE_NONE_TMOUT)
+
 /******************************************************************************
  * Test case definitions
  ******************************************************************************/
@@ -979,6 +1030,139 @@
 	                  CUTE_INHR_TEARDOWN, \
 	                  CUTE_INHR_TMOUT)
 
+/**
+ * Define a threaded test suite with attributes
+ *
+ * @param[in] _name     test suite name
+ * @param[in] _group    test group
+ * @param[in] _setup    setup fixture function
+ * @param[in] _teardown teardown fixture function
+ * @param[in] _tmout    test timeout
+ *
+ * Define a test suite designated by the @p _name variable with the specified
+ * attributes as explained in #CUTE_SUITE_DEFN.
+ *
+ * In addition, the test suite is marked as thread-safe: when
+ * cute_config::threads is greater than 1, test cases it aggregates, including
+ * these of nested sub-suites, may be run concurrently by multiple threads of
+ * the test @rstsubst{hierarchy} runner process. As a consequence, its test
+ * cases and @rstsubst{fixture} functions must not share unprotected state.
+ *
+ * Each thread is given its own @rstsubst{timeout} timer and exception
+ * handling context. Since standard output and error are process-wide
+ * resources, content they are fed with while running test cases of a threaded
+ * suite is captured on behalf of the suite as a whole.
+ *
+ * @see
+ * - #CUTE_THREAD_SUITE
+ * - #CUTE_THREAD_SUITE_STATIC
+ * - #CUTE_THREAD_SUITE_EXTERN
+ * - #CUTE_SUITE_DEFN
+ * - cute_config::threads
+ */
+#define CUTE_THREAD_SUITE_DEFN(_name, _group, _setup, _teardown, _tmout) \
+	const struct cute_suite _name = CUTE_THREAD_SUITE_INIT(# _name, \
+	                                                       _group, \
+	                                                       _setup, \
+	                                                       _teardown, \
+	                                                       _tmout)
+
+/**
+ * Define a static file scoped threaded test suite with attributes
+ *
+ * @param[in] _name     test suite name
+ * @param[in] _group    test group
+ * @param[in] _setup    setup fixture function
+ * @param[in] _teardown teardown fixture function
+ * @param[in] _tmout    test timeout
+ *
+ * Define a threaded test suite designated by the @p _name variable with static
+ * global file scope as explained in #CUTE_THREAD_SUITE_DEFN.
+ *
+ * @see
+ * - #CUTE_THREAD_SUITE
+ * - #CUTE_THREAD_SUITE_DEFN
+ * - #CUTE_THREAD_SUITE_EXTERN
+ */
+#define CUTE_THREAD_SUITE_STATIC(_name, _group, _setup, _teardown, _tmout) \
+	static CUTE_THREAD_SUITE_DEFN(_name, \
+	                              _group, \
+	                              _setup, \
+	                              _teardown, \
+	                              _tmout)
+
+/**
+ * Define a threaded test suite with attributes and external linkage.
+ *
+ * @param[in] _name     test suite name
+ * @param[in] _group    test group
+ * @param[in] _setup    setup fixture function
+ * @param[in] _teardown teardown fixture function
+ * @param[in] _tmout    test timeout
+ *
+ * Define a threaded test suite designated by the @p _name variable with
+ * external linkage as explained in #CUTE_THREAD_SUITE_DEFN.
+ *
+ * Use #CUTE_SUITE_DECL to produce a declaration in a header file so that the
+ * created test suite may be referenced from other compilation units.
+ *
+ * @see
+ * - #CUTE_THREAD_SUITE_DEFN
+ * - #CUTE_SUITE_DECL
+ * - #CUTE_THREAD_SUITE
+ * - #CUTE_THREAD_SUITE_STATIC
+ */
+#define CUTE_THREAD_SUITE_EXTERN(_name, _group, _setup, _teardown, _tmout) \
+	CUTE_THREAD_SUITE_DEFN(_name, \
+	                       _group, \
+	                       _setup, \
+	                       _teardown, \
+	                       _tmout)
+
+/**
+ * Define a threaded test suite with default class storage.
+ *
+ * @param[in] _name  test suite name
+ * @param[in] _group test group
+ *
+ * Define a threaded test suite designated by the @p _name variable with static
+ * global file scope which inherits @rstsubst{fixture} functions and
+ * @rstsubst{timeout} settings as explained in #CUTE_SUITE.
+ *
+ * See #CUTE_THREAD_SUITE_DEFN for more informations about threaded suites.
+ *
+ * @see
+ * - #CUTE_THREAD_SUITE_STATIC
+ * - #CUTE_THREAD_SUITE_EXTERN
+ * - #CUTE_THREAD_SUITE_DEFN
+ *
+ * **Example**
+ * @code{.c}
+ * CUTE_TEST(sample_test_0)
+ * {
+ *      cute_check_assert(0 == 0);
+ * }
+ *
+ * CUTE_TEST(sample_test_1)
+ * {
+ *      cute_check_assert(1 == 1);
+ * }
+ *
+ * CUTE_GROUP(sample_group) = {
+ *      CUTE_REF(sample_test_0),
+ *      CUTE_REF(sample_test_1)
+ * };
+ *
+ * CUTE_THREAD_SUITE(sample_suite, sample_group);
+ * @endcode
+ */
+#define CUTE_THREAD_SUITE(_name, _group) \
+	CUTE_THREAD_SUITE_STATIC(_name, \
+	                         _group, \
+	                         CUTE_INHR_SETUP, \
+	                         CUTE_INHR_TEARDOWN, \
+	                         CUTE_INHR_TMOUT)
+
 /**
  * Display informations about a test hierarchy node.
  *
@@ -1100,6 +1284,29 @@ enum cute_config_report {
 	CUTE_CONFIG_XML_REPORT    = (1U << 4)
 };
 
+/**
+ * Performance counter selector.
+ *
+ * Select a particular performance counter to sample while running each
+ * @rstsubst{test case} function.
+ *
+ * @see cute_config::perfs
+ */
+enum cute_config_perf {
+	/** Count instructions retired (hardware counter). */
+	CUTE_CONFIG_INSTR_PERF       = (1U << 0),
+	/** Count CPU cycles (hardware counter). */
+	CUTE_CONFIG_CYCLE_PERF       = (1U << 1),
+	/** Count cache misses (hardware counter). */
+	CUTE_CONFIG_CACHE_MISS_PERF  = (1U << 2),
+	/** Count mispredicted branches (hardware counter). */
+	CUTE_CONFIG_BRANCH_MISS_PERF = (1U << 3),
+	/** Measure CPU time in nanoseconds (software counter). */
+	CUTE_CONFIG_TASK_CLOCK_PERF  = (1U << 4),
+	/** Count page faults (software counter). */
+	CUTE_CONFIG_PAGE_FAULT_PERF  = (1U << 5)
+};
+
 /**
  * Console terminal probing strategy selector.
  *
@@ -1141,6 +1348,373 @@ struct cute_config {
 	 * @rstref{signal <user-signals>} and / or @rstsubst{timer} expiry.
 	 */
 	bool debug;
+	/**
+	 * Maximum number of tests run concurrently.
+	 *
+	 * When greater than 1, @rstsubst{test case} runs are dispatched to
+	 * cute_config::jobs worker processes so that up to cute_config::jobs
+	 * tests may be run concurrently.
+	 * Each worker process runs in its own address space, forked from the
+	 * test @rstsubst{hierarchy} runner process once all nodes have been
+	 * selected for running.
+	 *
+	 * Results are collected and reported in the exact same order as for a
+	 * sequential run. Tests must not rely upon side effects of previously
+	 * run tests.
+	 *
+	 * When set to 0 or 1, tests are run sequentially, one after another,
+	 * within the test @rstsubst{hierarchy} runner process.
+	 */
+	unsigned int jobs;
+	/**
+	 * Maximum number of threaded suite tests run concurrently.
+	 *
+	 * When greater than 1, @rstsubst{test case} runs belonging to a
+	 * @rstsubst{suite} defined using #CUTE_THREAD_SUITE_DEFN,
+	 * #CUTE_THREAD_SUITE_STATIC or #CUTE_THREAD_SUITE are dispatched to
+	 * up to cute_config::threads threads running within the test
+	 * @rstsubst{hierarchy} runner process.
+	 * Tests belonging to other suites are still run sequentially.
+	 *
+	 * Results are collected and reported in the exact same order as for a
+	 * sequential run.
+	 *
+	 * cute_config::threads is ignored when cute_config::jobs is greater
+	 * than 1.
+	 *
+	 * @see cute_config::jobs
+	 */
+	unsigned int threads;
+	/**
+	 * Run tests out of setup fixture snapshots.
+	 *
+	 * When enabled, the setup() @rstsubst{fixture} function of a
+	 * @rstsubst{suite} is run once on behalf of all enabled
+	 * @rstsubst{test case}s directly aggregated by the suite that inherit
+	 * it, i.e. defined using #CUTE_INHR_SETUP. Each of these tests is then
+	 * run within a separate process fork(2)'ed from the resulting state so
+	 * that all of them start from an identical copy-on-write post-setup
+	 * state.
+	 *
+	 * Tests teardown() @rstsubst{fixture} function is run as usual within
+	 * each test process. The suite teardown() @rstsubst{fixture} function
+	 * is run once all tests have completed to release the snapshot.
+	 *
+	 * Note that only the process state is snapshotted: setup fixtures
+	 * should not rely upon resources living outside of the process, such
+	 * as files or threads.
+	 *
+	 * Should the setup() @rstsubst{fixture} function fail, tests are run
+	 * the usual way.
+	 *
+	 * cute_config::snapshot is ignored when cute_config::jobs is greater
+	 * than 1 and for threaded suites when cute_config::threads is greater
+	 * than 1.
+	 */
+	bool         snapshot;
+	/**
+	 * Index of the shard to run.
+	 *
+	 * 0-based index identifying the subset of @rstsubst{test case}s to
+	 * run among the cute_config::shards disjoint subsets the test
+	 * @rstsubst{hierarchy} is split into.
+	 *
+	 * Must be lower than cute_config::shards.
+	 *
+	 * @see cute_config::shards
+	 */
+	unsigned int shard;
+	/**
+	 * Number of shards to split the test hierarchy into.
+	 *
+	 * When greater than 1, @rstsubst{test case}s are split into
+	 * cute_config::shards disjoint subsets and only tests belonging to the
+	 * subset identified by cute_config::shard are enabled.
+	 * A test is assigned to a subset according to a hash of its full name
+	 * so that assignment is stable across runs and hosts. Running all
+	 * cute_config::shards subsets therefore covers the whole test
+	 * @rstsubst{hierarchy} exactly once.
+	 *
+	 * @rstsubst{suite}s are enabled only when at least one of their
+	 * descendant tests is.
+	 *
+	 * Must be greater than 0.
+	 *
+	 * @see cute_config::shard
+	 */
+	unsigned int shards;
+	/**
+	 * Test run history pathname.
+	 *
+	 * Pathname to a @rstref{JUnit XML report <sect-user-junit>} or a
+	 * cute-report(1) database holding results of a previous run.
+	 *
+	 * When not ``NULL`` and tests are dispatched to multiple workers (see
+	 * cute_config::jobs and cute_config::threads), @rstsubst{test case}s
+	 * are dispatched longest first according to the durations recorded
+	 * into cute_config::hist_path file so that wall-clock time of the whole
+	 * run is not dominated by long tests started last.
+	 * Tests missing from the history are dispatched first, in the order a
+	 * sequential run would complete them.
+	 *
+	 * Results are still reported in the exact same order as for a
+	 * sequential run.
+	 *
+	 * @see
+	 * - cute_config::jobs
+	 * - cute_config::threads
+	 */
+	const char * hist_path;
+	/**
+	 * Failed tests report pathname.
+	 *
+	 * Pathname to a @rstref{JUnit XML report <sect-user-junit>}, a
+	 * cute-report(1) database or a TAP report holding results of a
+	 * previous run.
+	 *
+	 * When not ``NULL``, only @rstsubst{test case}s recorded as either
+	 * failed or crashed into cute_config::rerun_path file are enabled.
+	 * Tests are selected according to their full name so that no regular
+	 * expression is needed.
+	 * @rstsubst{suite}s are enabled only when at least one of their
+	 * descendant tests is.
+	 */
+	const char * rerun_path;
+	/**
+	 * Selected suite or test full name.
+	 *
+	 * When not ``NULL``, only the @rstsubst{suite} or @rstsubst{test case}
+	 * which full name is cute_config::name, as well as its descendants,
+	 * are enabled. Full names are compared as plain strings so that no
+	 * regular expression is needed and unrelated parts of the test
+	 * @rstsubst{hierarchy} are skipped altogether.
+	 * Parent @rstsubst{suite}s of the selected node are enabled too.
+	 */
+	const char * name;
+	/**
+	 * Include selectors.
+	 *
+	 * When not ``NULL``, a ``NULL`` terminated array of shell wildcard
+	 * patterns (see fnmatch(3)) matched against full names, where ``*``
+	 * also matches ``::`` separators. Only the @rstsubst{suite}s and
+	 * @rstsubst{test case}s matching at least one of them, as well as
+	 * their descendants, are enabled.
+	 * Patterns without any wildcard are compared to full names as plain
+	 * strings.
+	 *
+	 * @see cute_config::excludes
+	 */
+	const char * const * includes;
+	/**
+	 * Exclude selectors.
+	 *
+	 * When not ``NULL``, a ``NULL`` terminated array of shell wildcard
+	 * patterns matched the same way as cute_config::includes. The
+	 * @rstsubst{suite}s and @rstsubst{test case}s matching at least one of
+	 * them, as well as their descendants, are disabled, whether they are
+	 * selected by cute_config::includes or not.
+	 *
+	 * @see cute_config::includes
+	 */
+	const char * const * excludes;
+	/**
+	 * Passed tests result cache directory pathname.
+	 *
+	 * When not ``NULL``, full names of @rstsubst{test case}s that passed
+	 * are recorded into a file named after the build ID of the running
+	 * executable under cute_config::cache_path directory. Tests found into
+	 * this file by subsequent runs of the very same executable are
+	 * reported as cached passes without being executed.
+	 *
+	 * As a rebuilt executable is given another build ID, previously cached
+	 * results are ignored automatically. The cache is disabled when the
+	 * executable has been linked without the ``--build-id`` linker option.
+	 */
+	const char * cache_path;
+	/**
+	 * Maximum number of failed tests before cutting the run short.
+	 *
+	 * When greater than 0, no more @rstsubst{test case}s are started once
+	 * cute_config::fail_fast tests have either failed or crashed. Tests
+	 * that have not been started yet are reported with the ``cut`` issue
+	 * and the run is reported as cut short by all enabled reporters.
+	 *
+	 * When tests are run concurrently (see cute_config::jobs and
+	 * cute_config::threads), tests already running complete normally so
+	 * that more than cute_config::fail_fast tests may eventually fail.
+	 *
+	 * When 0, all requested tests are run regardless of failures.
+	 */
+	unsigned int fail_fast;
+	/**
+	 * Number of times each test is run.
+	 *
+	 * When greater than 1, every enabled @rstsubst{test case} is run
+	 * cute_config::repeat times in a row within the same process. The
+	 * number of passed and failed iterations as well as the distribution of
+	 * their durations are reported for each test so that flaky and
+	 * jittery tests may be spotted.
+	 *
+	 * A test is reported with the outcome of its first failed iteration
+	 * if any, or with the outcome of its last iteration otherwise.
+	 *
+	 * Must be greater than 0.
+	 *
+	 * @see cute_config::until_fail
+	 */
+	unsigned int repeat;
+	/**
+	 * Stop repeating a test at its first failure.
+	 *
+	 * When ``true``, repetitions of a @rstsubst{test case} stop as soon as
+	 * one of its iterations either fails or crashes.
+	 *
+	 * Ignored unless cute_config::repeat is greater than 1.
+	 */
+	bool         until_fail;
+	/**
+	 * Run tests in random order.
+	 *
+	 * When ``true``, @rstsubst{test case}s and @rstsubst{suite}s
+	 * aggregated by a common parent @rstsubst{suite} are run in a random
+	 * order computed according to cute_config::seed. Tests are reported
+	 * in the order they are run.
+	 *
+	 * Running tests in random order helps spotting tests that depend on
+	 * state left behind by previously run tests.
+	 *
+	 * @see cute_config::seed
+	 * @see cute_config::bisect
+	 */
+	bool         shuffle;
+	/**
+	 * Random test order seed.
+	 *
+	 * Seed used to compute the random test order when cute_config::shuffle
+	 * is ``true``. Given the same test @rstsubst{hierarchy}, a given seed
+	 * always leads to the same test order so that a random order may be
+	 * reproduced.
+	 *
+	 * Ignored unless cute_config::shuffle is ``true``.
+	 */
+	unsigned int seed;
+	/**
+	 * Search for order dependencies when a shuffled run fails.
+	 *
+	 * When ``true`` and at least one @rstsubst{test case} failed, tests
+	 * are run again within separate processes according to shrinking
+	 * prefixes of the random test order until the smallest pair of tests
+	 * reproducing the failure is found. The pair found is reported once
+	 * the run completes.
+	 *
+	 * Ignored unless cute_config::shuffle is ``true``.
+	 */
+	bool         bisect;
+	/**
+	 * Test CPU time budget in milliseconds.
+	 *
+	 * When greater than 0, each @rstsubst{test case} run is interrupted
+	 * and marked as failing once the thread running it has consumed
+	 * cute_config::cpu_tmout milliseconds of CPU time, regardless of its
+	 * @rstsubst{timeout}. This allows to tell a test spinning in a busy
+	 * loop apart from a test blocked waiting for some event, and to cut
+	 * the former short.
+	 *
+	 * Ignored in debug mode (see cute_config::debug).
+	 *
+	 * When 0, tests are not given any CPU time budget.
+	 */
+	unsigned int cpu_tmout;
+	/**
+	 * Startup profiling.
+	 *
+	 * When ``true``, time spent into each initialization stage is printed
+	 * onto standard error in nanoseconds. Stages deferred till first
+	 * needed, such as loading build properties or setting up standard I/O
+	 * capture, are printed once they are completed.
+	 */
+	bool         profile;
+	/**
+	 * Performance counter selector mask.
+	 *
+	 * When not 0, counters specified as a mask of cute_config_perf
+	 * values are sampled using perf_event_open(2) while running each
+	 * @rstsubst{test case} function and recorded into
+	 * @rstref{TAP <sect-user-tap>} and
+	 * @rstref{JUnit XML <sect-user-junit>} reports. Only user space
+	 * activity is counted.
+	 *
+	 * When none of the hardware counters requested is available, as is
+	 * often the case within containers or virtual machines, software
+	 * counters are sampled instead.
+	 *
+	 * @see cute_config_perf
+	 */
+	unsigned int perfs;
+	/**
+	 * Heap allocation tracking.
+	 *
+	 * When ``true``, heap allocations performed by the thread running each
+	 * @rstsubst{test case}, from the start of its setup fixture till the
+	 * end of its teardown fixture, are accounted for and recorded into
+	 * @rstref{TAP <sect-user-tap>} and
+	 * @rstref{JUnit XML <sect-user-junit>} reports: number of
+	 * allocations, bytes allocated and peak heap usage.
+	 *
+	 * A test that passed but left blocks allocated behind is marked as
+	 * failing. Blocks may be released by any thread.
+	 *
+	 * Allocations of threads spawned by a test are tracked as well, except
+	 * for tests of threaded suites run concurrently (see
+	 * cute_config::threads).
+	 *
+	 * Requires the test program to be linked against the
+	 * ``libcute-heap.so`` helper library or to be run with it preloaded:
+	 * cute_init() fails otherwise.
+	 *
+	 * Resources glibc allocates lazily and keeps for the lifetime of the
+	 * process are not charged to tests only when allocated before tracking
+	 * starts, standard output and error buffers apart. These include
+	 * timezone data and stacks of exited threads cached by
+	 * pthread_create(3).
+	 *
+	 * @see cute_heap_ignore()
+	 */
+	bool         heap;
+	/**
+	 * File descriptor and thread leak detection.
+	 *
+	 * When ``true``, file descriptors open and threads running are listed
+	 * right before each @rstsubst{test case} setup fixture runs and right
+	 * after its teardown fixture completes. A test that passed but left
+	 * descriptors open or threads running behind is marked as failing and
+	 * the targets of descriptors left open are given as failure reason.
+	 *
+	 * Tests of threaded suites run concurrently (see
+	 * cute_config::threads) are not checked since they share descriptors
+	 * and threads.
+	 */
+	bool         leaks;
+	/**
+	 * Per test code coverage directory pathname.
+	 *
+	 * When not ``NULL``, gcov counters are cleared right before each
+	 * @rstsubst{test case} setup fixture runs and dumped right after its
+	 * teardown fixture completes under a directory of its own located
+	 * under cute_config::cov_path and named after the test full name where
+	 * ``::`` separators are replaced by ``/``. A ``manifest.txt`` file
+	 * mapping test full names to these directories, one test per line, is
+	 * written under cute_config::cov_path once all tests are run.
+	 *
+	 * This requires CUTe to be built with ``CONFIG_CUTE_COVERAGE``
+	 * enabled and the test executable to be built with the ``--coverage``
+	 * compiler option. Counters are merged into data files left by
+	 * previous runs, if any.
+	 *
+	 * Tests of threaded suites run concurrently (see
+	 * cute_config::threads) are not recorded since they share counters.
+	 */
+	const char * cov_path;
 	/**
 	 * Test report selector mask.
 	 *
@@ -1219,16 +1793,55 @@ struct cute_config {
  *
  * - @rstsubst{test case} and @rstsubst{suite} nodes are all enabled,
  * - debug mode is off,
+ * - tests are run sequentially,
+ * - setup fixtures are run once per test,
+ * - the whole test hierarchy is run as a single shard,
+ * - tests are dispatched in the order a sequential run completes them,
+ * - tests are selected regardless of previous run results,
+ * - tests are selected regardless of their full name,
+ * - no tests are included nor excluded by wildcard selectors,
+ * - test results are not cached,
+ * - all tests are run regardless of failures,
+ * - tests are run once, in declaration order,
+ * - tests are not given any CPU time budget,
+ * - startup profiling is disabled,
+ * - no performance counters are sampled,
+ * - heap allocations are not tracked,
+ * - file descriptor and thread leaks are not detected,
+ * - per test code coverage is not recorded,
  * - #CUTE_CONFIG_TERSE_REPORT is enabled,
  * - #CUTE_CONFIG_PROBE_TTY is enabled.
  */
 #define CUTE_CONFIG_INIT \
 	{ \
-		.debug    = false, \
-		.reports  = 0, \
-		.tty      = CUTE_CONFIG_PROBE_TTY, \
-		.tap_path = NULL, \
-		.xml_path = NULL \
+		.debug     = false, \
+		.jobs      = 1, \
+		.threads   = 1, \
+		.snapshot  = false, \
+		.shard     = 0, \
+		.shards    = 1, \
+		.hist_path = NULL, \
+		.rerun_path = NULL, \
+		.name      = NULL, \
+		.includes  = NULL, \
+		.excludes  = NULL, \
+		.cache_path = NULL, \
+		.fail_fast = 0, \
+		.repeat    = 1, \
+		.until_fail = false, \
+		.shuffle   = false, \
+		.seed      = 0, \
+		.bisect    = false, \
+		.cpu_tmout = 0, \
+		.profile   = false, \
+		.perfs     = 0, \
+		.heap      = false, \
+		.leaks     = false, \
+		.cov_path  = NULL, \
+		.reports   = 0, \
+		.tty       = CUTE_CONFIG_PROBE_TTY, \
+		.tap_path  = NULL, \
+		.xml_path  = NULL \
 	}
 
 /**
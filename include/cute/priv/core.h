@@ -8,6 +8,8 @@
 #ifndef _CUTE_PRIV_CORE_H
 #define _CUTE_PRIV_CORE_H
 
+#include <stdbool.h>
+
 #define __cute_export \
 	__attribute__((visibility("default")))
 
@@ -24,7 +26,11 @@ typedef void (cute_test_fn)(void);
 #define CUTE_NULL_FIXTURE ((cute_test_fn *)0)
 #define CUTE_INHR_FIXTURE ((cute_test_fn *)1)
 
-typedef struct cute_iter * (cute_iter_fn)(const struct cute_base * base);
+/* Flags timeouts expressed in milliseconds instead of seconds. */
+#define CUTE_MSEC_TMOUT_FLAG (1U << 30)
+
+typedef bool (cute_iter_fn)(const struct cute_base * base,
+                            struct cute_iter *       iter);
 
 typedef struct cute_run * (cute_run_fn)(const struct cute_base * base,
                                         struct cute_run *        parent);
@@ -80,10 +86,12 @@ struct cute_suite {
 	const struct cute_base * const * tests;
 };
 
-#define CUTE_SUITE_INIT(_name, _tests, _setup, _teardown, _tmout) \
+extern const struct cute_ops cute_thread_suite_ops __cute_export;
+
+#define _CUTE_SUITE_INIT(_name, _ops, _tests, _setup, _teardown, _tmout) \
 	{ \
 		.super = CUTE_BASE_INIT(_name, \
-		                        &cute_suite_ops, \
+		                        _ops, \
 		                        _setup, \
 		                        _teardown, \
 		                        _tmout), \
@@ -91,6 +99,22 @@ struct cute_suite {
 		.tests = _tests \
 	}
 
+#define CUTE_SUITE_INIT(_name, _tests, _setup, _teardown, _tmout) \
+	_CUTE_SUITE_INIT(_name, \
+	                 &cute_suite_ops, \
+	                 _tests, \
+	                 _setup, \
+	                 _teardown, \
+	                 _tmout)
+
+#define CUTE_THREAD_SUITE_INIT(_name, _tests, _setup, _teardown, _tmout) \
+	_CUTE_SUITE_INIT(_name, \
+	                 &cute_thread_suite_ops, \
+	                 _tests, \
+	                 _setup, \
+	                 _teardown, \
+	                 _tmout)
+
 extern int
 cute_main(int                       argc,
           char * const              argv[],
@@ -12,8 +12,8 @@
 #include <cute/types.h>
 #include <setjmp.h>
 
-extern sigjmp_buf cute_expect_assert_env __cute_export;
-extern bool       cute_expect_assert __cute_export;
+extern __thread sigjmp_buf cute_expect_assert_env __cute_export;
+extern __thread bool       cute_expect_assert __cute_export;
 
 extern void
 cute_expect_fail_assert(const char * file, int line, const char * function)
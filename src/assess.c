@@ -142,6 +142,56 @@ cute_assess_build_assert(struct cute_assess * assess, const char * expr)
 	assess->expect.expr = expr;
 }
 
+static struct cute_text_block *
+cute_assess_desc_text(const struct cute_assess * assess)
+{
+	cute_assess_assert_intern(assess);
+	cute_assert_intern(assess->check.expr);
+	cute_assert_intern(assess->expect.uint.scal.value);
+
+	size_t                   sz = (size_t)assess->expect.uint.scal.value;
+	const char *             str;
+	unsigned int             nr = 0;
+	struct cute_text_block * blk;
+
+	cute_foreach_string(str, assess->check.expr, sz)
+		nr++;
+
+	blk = cute_text_create(nr);
+
+	cute_foreach_string(str, assess->check.expr, sz)
+		cute_text_asprintf(blk, "%s", str);
+
+	return blk;
+}
+
+static const struct cute_assess_ops cute_assess_text_ops = {
+	.cmp     = cute_assess_cmp_null,
+	.desc    = cute_assess_desc_text,
+	.release = cute_assess_release_null
+};
+
+/*
+ * Build an assessment which description is given as a pre-rendered set of
+ * NULL terminated strings stored contiguously into the text buffer.
+ * Text buffer is not owned: caller must keep it alive for the whole assessment
+ * lifetime.
+ */
+void
+cute_assess_build_text(struct cute_assess * assess,
+                       const char *         text,
+                       size_t               size)
+{
+	cute_assert_intern(assess);
+	cute_assert_intern(text);
+	cute_assert_intern(size > 1);
+	cute_assert_intern(!text[size - 1]);
+
+	assess->ops = &cute_assess_text_ops;
+	assess->check.expr = text;
+	assess->expect.uint.scal.value = size;
+}
+
 static struct cute_text_block *
 cute_assess_desc_excp(const struct cute_assess * assess)
 {
@@ -153,6 +153,11 @@ cute_assess_build_assert(struct cute_assess * assess, const char * expr);
 extern void
 cute_assess_build_excp(struct cute_assess * assess, int sig);
 
+extern void
+cute_assess_build_text(struct cute_assess * assess,
+                       const char *         text,
+                       size_t               size);
+
 /******************************************************************************
  * Boolean numbers handling
  ******************************************************************************/
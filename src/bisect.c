@@ -0,0 +1,370 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Test order dependency bisection.
+ *
+ * When a shuffled run fails, tests are run again according to shrinking
+ * prefixes of the order they were run into so that the smallest pair of tests
+ * reproducing a failure may be found, i.e. a test leaving some state behind
+ * and a test failing because of it.
+ *
+ * Each trial must start from a pristine process state. A spawner process is
+ * therefore fork(2)'ed before any test is run. For each trial, it is given a
+ * sequence of test runs, then fork(2)s a child that completes them in order
+ * with reporting diverted. The child exit status tells whether the last test
+ * of the sequence failed or not.
+ * Since the spawner is a copy of the parent process, test runs are given as
+ * plain pointers into the run tree.
+ */
+
+#include "bisect.h"
+#include "suite.h"
+#include "pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+const struct cute_run * cute_bisect_culprit;
+const struct cute_run * cute_bisect_victim;
+
+static pid_t            cute_bisect_pid = -1;
+static int              cute_bisect_sock = -1;
+
+/******************************************************************************
+ * Spawner process side
+ ******************************************************************************/
+
+static bool
+cute_bisect_failed(const struct cute_run * run)
+{
+	return (run->issue == CUTE_FAIL_ISSUE) ||
+	       (run->issue == CUTE_EXCP_ISSUE);
+}
+
+static int
+cute_bisect_try(int sock, struct cute_run * const * runs, unsigned int nr)
+{
+	cute_assert_intern(runs);
+	cute_assert_intern(nr);
+
+	pid_t pid;
+	int   status = 0;
+
+	fflush(NULL);
+
+	pid = fork();
+	if (pid < 0)
+		return -errno;
+
+	if (!pid) {
+		unsigned int r;
+
+		close(sock);
+
+		if (cute_iodir_respawn() || cute_run_respawn_sigs())
+			_exit(2);
+
+		/* Run each test once, whatever the outcome of previous ones. */
+		cute_the_config->fail_fast = 0;
+		cute_the_config->repeat = 1;
+
+		for (r = 0; r < nr; r++)
+			cute_run_oper(runs[r], CUTE_COMPLETE_OPER);
+
+		_exit(cute_bisect_failed(runs[nr - 1]) ? 1 : 0);
+	}
+
+	while ((waitpid(pid, &status, 0) < 0) && (errno == EINTR))
+		;
+
+	if (WIFSIGNALED(status))
+		/* Test process died: failure is reproduced. */
+		return 1;
+	else if (WIFEXITED(status) && (WEXITSTATUS(status) <= 1))
+		return WEXITSTATUS(status);
+
+	return -ECHILD;
+}
+
+static void __cute_noreturn
+cute_bisect_spawn(int sock)
+{
+	cute_assert_intern(sock >= 0);
+
+	struct cute_run ** runs = NULL;
+	unsigned int       max = 0;
+	unsigned int       events;
+
+	if (cute_iodir_respawn())
+		_exit(EXIT_FAILURE);
+
+	cute_report_divert(&events);
+
+	while (true) {
+		unsigned int nr;
+		int          ret;
+
+		if (cute_pool_recv(sock, &nr, sizeof(nr)) || !nr)
+			/* Parent process is done with us. */
+			break;
+
+		if (nr > max) {
+			runs = cute_realloc(runs, nr * sizeof(runs[0]));
+			max = nr;
+		}
+
+		if (cute_pool_recv(sock, runs, nr * sizeof(runs[0])))
+			break;
+
+		ret = cute_bisect_try(sock, runs, nr);
+		if (cute_pool_send(sock, &ret, sizeof(ret)))
+			break;
+	}
+
+	cute_free(runs);
+
+	_exit(EXIT_SUCCESS);
+}
+
+/******************************************************************************
+ * Parent process side
+ ******************************************************************************/
+
+struct cute_bisect_seq {
+	struct cute_run ** runs;
+	unsigned int       nr;
+};
+
+static void
+cute_bisect_collect_run(struct cute_run * run,
+                        enum cute_visit   visit,
+                        void *            data)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(data);
+
+	struct cute_bisect_seq * seq = (struct cute_bisect_seq *)data;
+
+	if ((visit != CUTE_ONCE_VISIT) ||
+	    (run->base->ops != &cute_test_ops) ||
+	    run->cached)
+		return;
+
+	switch (run->issue) {
+	case CUTE_PASS_ISSUE:
+	case CUTE_SKIP_ISSUE:
+	case CUTE_FAIL_ISSUE:
+	case CUTE_EXCP_ISSUE:
+		seq->runs[seq->nr++] = run;
+		break;
+
+	case CUTE_OFF_ISSUE:
+	case CUTE_CUT_ISSUE:
+		break;
+
+	default:
+		__cute_unreachable();
+	}
+}
+
+/*
+ * Run the given sequence of tests within a pristine process and return 1 when
+ * the last one failed, 0 when it did not or a negative errno like code when
+ * trial could not be completed.
+ */
+static int
+cute_bisect_probe(struct cute_run * const * runs, unsigned int nr)
+{
+	cute_assert_intern(cute_bisect_sock >= 0);
+	cute_assert_intern(runs);
+	cute_assert_intern(nr);
+
+	int ret;
+
+	if (cute_pool_send(cute_bisect_sock, &nr, sizeof(nr)) ||
+	    cute_pool_send(cute_bisect_sock, runs, nr * sizeof(runs[0])) ||
+	    cute_pool_recv(cute_bisect_sock, &ret, sizeof(ret)))
+		return -EPIPE;
+
+	return ret;
+}
+
+static int
+cute_bisect_probe_prefix(const struct cute_bisect_seq * seq,
+                         unsigned int                   len,
+                         struct cute_run *              victim,
+                         struct cute_run **             trial)
+{
+	cute_assert_intern(len < seq->nr);
+
+	memcpy(trial, seq->runs, len * sizeof(trial[0]));
+	trial[len] = victim;
+
+	return cute_bisect_probe(trial, len + 1);
+}
+
+/*
+ * Find the smallest prefix of tests run before victim that still makes it
+ * fail: the last test of this prefix is the culprit. Return 1 when a pair of
+ * tests reproducing the failure on their own has been found.
+ */
+static int
+cute_bisect_search(const struct cute_bisect_seq * seq,
+                   unsigned int                   vict,
+                   struct cute_run **             trial)
+{
+	cute_assert_intern(vict);
+	cute_assert_intern(vict < seq->nr);
+
+	struct cute_run * victim = seq->runs[vict];
+	unsigned int      lo = 1;
+	unsigned int      hi = vict;
+	int               ret;
+
+	/* Failing on its own: not an order dependency. */
+	ret = cute_bisect_probe(&victim, 1);
+	if (ret)
+		return (ret < 0) ? ret : 0;
+
+	/* Failure must be reproducible using the whole prefix. */
+	ret = cute_bisect_probe_prefix(seq, hi, victim, trial);
+	if (ret <= 0)
+		return ret;
+
+	while (lo < hi) {
+		unsigned int mid = lo + ((hi - lo) / 2);
+
+		ret = cute_bisect_probe_prefix(seq, mid, victim, trial);
+		if (ret < 0)
+			return ret;
+
+		if (ret)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	trial[0] = seq->runs[hi - 1];
+	trial[1] = victim;
+	ret = cute_bisect_probe(trial, 2);
+	if (ret <= 0)
+		return ret;
+
+	cute_bisect_culprit = trial[0];
+	cute_bisect_victim = victim;
+
+	return 1;
+}
+
+void
+cute_bisect_run(struct cute_run * root)
+{
+	cute_run_assert_intern(root);
+
+	const struct cute_suite_run * suite = (struct cute_suite_run *)root;
+	struct cute_bisect_seq        seq;
+	struct cute_run **            trial;
+	unsigned int                  v;
+	int                           ret = 0;
+
+	if (cute_bisect_pid < 0)
+		return;
+
+	if (!suite->sums.fail && !suite->sums.excp)
+		return;
+
+	seq.runs = cute_malloc(suite->sums.total * sizeof(seq.runs[0]));
+	seq.nr = 0;
+	cute_run_foreach(root, cute_bisect_collect_run, &seq);
+
+	trial = cute_malloc((seq.nr + 1) * sizeof(trial[0]));
+
+	for (v = 1; v < seq.nr; v++) {
+		if (!cute_bisect_failed(seq.runs[v]))
+			continue;
+
+		ret = cute_bisect_search(&seq, v, trial);
+		if (ret)
+			break;
+	}
+
+	if (ret < 0)
+		cute_error("cannot bisect test order: %s.\n", strerror(-ret));
+
+	cute_free(trial);
+	cute_free(seq.runs);
+}
+
+void
+cute_bisect_init(void)
+{
+	cute_config_assert_intern(cute_the_config);
+	cute_assert_intern(cute_bisect_pid < 0);
+	cute_assert_intern(cute_bisect_sock < 0);
+
+	int   socks[2];
+	pid_t pid;
+
+	cute_bisect_culprit = NULL;
+	cute_bisect_victim = NULL;
+
+	if (!cute_the_config->shuffle || !cute_the_config->bisect)
+		return;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, socks))
+		goto err;
+
+	/* Prevent spawner from flushing pending output a second time. */
+	fflush(NULL);
+
+	pid = fork();
+	if (pid < 0) {
+		int err = errno;
+
+		close(socks[0]);
+		close(socks[1]);
+		errno = err;
+		goto err;
+	}
+
+	if (!pid) {
+		close(socks[0]);
+		cute_bisect_spawn(socks[1]);
+	}
+
+	close(socks[1]);
+
+	cute_bisect_pid = pid;
+	cute_bisect_sock = socks[0];
+
+	return;
+
+err:
+	cute_error("cannot spawn test order bisection process: %s.\n",
+	           strerror(errno));
+}
+
+void
+cute_bisect_fini(void)
+{
+	unsigned int nr = 0;
+
+	if (cute_bisect_pid < 0)
+		return;
+
+	/* Tell spawner to exit. */
+	cute_pool_send(cute_bisect_sock, &nr, sizeof(nr));
+	close(cute_bisect_sock);
+
+	while ((waitpid(cute_bisect_pid, NULL, 0) < 0) && (errno == EINTR))
+		;
+
+	cute_bisect_pid = -1;
+	cute_bisect_sock = -1;
+}
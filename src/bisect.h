@@ -0,0 +1,25 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_BISECT_H
+#define _CUTE_BISECT_H
+
+#include "run.h"
+
+extern const struct cute_run * cute_bisect_culprit;
+extern const struct cute_run * cute_bisect_victim;
+
+extern void
+cute_bisect_run(struct cute_run * root);
+
+extern void
+cute_bisect_init(void);
+
+extern void
+cute_bisect_fini(void);
+
+#endif /* _CUTE_BISECT_H */
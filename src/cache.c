@@ -0,0 +1,193 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Passed tests result cache.
+ *
+ * Full names of passed tests are stored into a file named after the build ID
+ * of the running executable under cute_config::cache_path directory, one name
+ * per line. A rebuilt executable is given another build ID and therefore
+ * never finds results recorded for previous builds.
+ *
+ * Cache is disabled when the executable carries no build ID.
+ */
+
+#include "cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static char *  cute_cache_path;
+static char *  cute_cache_data;
+static char ** cute_cache_names;
+static size_t  cute_cache_nr;
+
+static int
+cute_cache_cmp_name(const void * first, const void * second)
+{
+	return strcmp(*(char * const *)first, *(char * const *)second);
+}
+
+static int
+cute_cache_cmp_key(const void * key, const void * name)
+{
+	return strcmp((const char *)key, *(char * const *)name);
+}
+
+bool
+cute_cache_probe(const char * name)
+{
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+
+	if (!cute_cache_nr)
+		return false;
+
+	return !!bsearch(name,
+	                 cute_cache_names,
+	                 cute_cache_nr,
+	                 sizeof(cute_cache_names[0]),
+	                 cute_cache_cmp_key);
+}
+
+static void
+cute_cache_store_run(struct cute_run * run,
+                     enum cute_visit   visit,
+                     void *            data)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(data);
+
+	if ((visit != CUTE_ONCE_VISIT) ||
+	    (run->base->ops != &cute_test_ops) ||
+	    (run->issue != CUTE_PASS_ISSUE) ||
+	    cute_cache_probe(run->name))
+		return;
+
+	fprintf((FILE *)data, "%s\n", run->name);
+}
+
+static void
+cute_cache_store_all(FILE * stdio, void * data)
+{
+	cute_assert_intern(stdio);
+	cute_run_assert_intern((struct cute_run *)data);
+
+	size_t n;
+
+	for (n = 0; n < cute_cache_nr; n++)
+		fprintf(stdio, "%s\n", cute_cache_names[n]);
+
+	cute_run_foreach((struct cute_run *)data, cute_cache_store_run, stdio);
+}
+
+/*
+ * Record tests passed by the current run in addition to previously cached
+ * ones so that tests not selected by this run are not evicted.
+ *
+ * Cache file is replaced atomically so that concurrent runs of the same
+ * executable never load a partial cache.
+ */
+void
+cute_cache_store(struct cute_run * root)
+{
+	cute_run_assert_intern(root);
+
+	int err;
+
+	if (!cute_cache_path)
+		return;
+
+	err = cute_store_file(cute_cache_path, cute_cache_store_all, root);
+	if (err)
+		cute_error("'%s': cannot store result cache: %s.\n",
+		           cute_cache_path,
+		           strerror(-err));
+}
+
+static void
+cute_cache_parse(char * data)
+{
+	cute_assert_intern(data);
+
+	size_t max = 0;
+	char * name;
+
+	for (name = strtok(data, "\n"); name; name = strtok(NULL, "\n")) {
+		if (cute_cache_nr == max) {
+			max = max ? (2 * max) : 64;
+			cute_cache_names =
+				cute_realloc(cute_cache_names,
+				             max * sizeof(cute_cache_names[0]));
+		}
+
+		cute_cache_names[cute_cache_nr++] = name;
+	}
+
+	if (cute_cache_nr)
+		qsort(cute_cache_names,
+		      cute_cache_nr,
+		      sizeof(cute_cache_names[0]),
+		      cute_cache_cmp_name);
+}
+
+int
+cute_cache_load(const char * dir)
+{
+	cute_assert_intern(dir);
+	cute_assert_intern(dir[0]);
+	cute_assert_intern(!cute_cache_path);
+	cute_assert_intern(!cute_cache_nr);
+
+	size_t size;
+	int    err;
+
+	if (!cute_build_id)
+		return 0;
+
+	if (mkdir(dir, 0755) && (errno != EEXIST)) {
+		err = -errno;
+		cute_error("'%s': cannot create result cache directory: %s.\n",
+		           dir,
+		           strerror(-err));
+		return err;
+	}
+
+	cute_cache_path = cute_malloc(strlen(dir) + 1 +
+	                              strlen(cute_build_id) + 1);
+	sprintf(cute_cache_path, "%s/%s", dir, cute_build_id);
+
+	err = cute_load_file(cute_cache_path, &cute_cache_data, &size);
+	if (!err) {
+		cute_cache_parse(cute_cache_data);
+		return 0;
+	}
+
+	if (err == -ENOENT)
+		/* Nothing cached yet for this build. */
+		return 0;
+
+	cute_error("'%s': cannot load result cache: %s.\n",
+	           cute_cache_path,
+	           strerror(-err));
+	cute_cache_unload();
+
+	return err;
+}
+
+void
+cute_cache_unload(void)
+{
+	cute_free(cute_cache_names);
+	cute_free(cute_cache_data);
+	cute_free(cute_cache_path);
+
+	cute_cache_names = NULL;
+	cute_cache_nr = 0;
+	cute_cache_data = NULL;
+	cute_cache_path = NULL;
+}
@@ -0,0 +1,25 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_CACHE_H
+#define _CUTE_CACHE_H
+
+#include "run.h"
+
+extern bool
+cute_cache_probe(const char * name);
+
+extern void
+cute_cache_store(struct cute_run * root);
+
+extern int
+cute_cache_load(const char * dir);
+
+extern void
+cute_cache_unload(void);
+
+#endif /* _CUTE_CACHE_H */
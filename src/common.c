@@ -8,8 +8,10 @@
 #include "common.h"
 #include "run.h"
 #include "report.h"
+#include "hist.h"
 #include <stdlib.h>
 #include <string.h>
+#include <fnmatch.h>
 #include <link.h>
 #include <gelf.h>
 #include <sys/auxv.h>
@@ -21,9 +23,11 @@ char *              cute_build_id;
 struct cute_prop    cute_build_tool;
 struct cute_prop    cute_build_flags;
 struct cute_prop    cute_build_conf;
-sigjmp_buf          cute_jmp_env;
+__thread sigjmp_buf cute_jmp_env;
 unsigned int        cute_run_nr;
 static const char * cute_pattern;
+static bool         cute_literal;
+static bool         cute_icase;
 static regex_t      cute_regex;
 
 const char *
@@ -55,7 +59,8 @@ cute_issue_label(enum cute_issue issue)
 		[CUTE_SKIP_ISSUE] = "skip",
 		[CUTE_FAIL_ISSUE] = "fail",
 		[CUTE_EXCP_ISSUE] = "excp",
-		[CUTE_OFF_ISSUE]  = "off"
+		[CUTE_OFF_ISSUE]  = "off",
+		[CUTE_CUT_ISSUE]  = "cut"
 	};
 
 	return labels[issue];
@@ -79,61 +84,356 @@ cute_match_parse(const char * pattern)
 	return 0;
 }
 
-bool
-cute_match_run(const struct cute_run * run)
+/*
+ * 32-bit FNV-1a hash of full name used to assign tests to shards and to index
+ * the run tree: it is cheap, spreads names evenly and does not depend upon host
+ * or build properties.
+ */
+unsigned int
+cute_match_hash(const char * name)
+{
+	cute_assert_intern(name);
+
+	uint32_t hash = UINT32_C(2166136261);
+
+	while (*name) {
+		hash ^= (uint32_t)(unsigned char)*name++;
+		hash *= UINT32_C(16777619);
+	}
+
+	return (unsigned int)hash;
+}
+
+/*
+ * Include / exclude selectors.
+ *
+ * Selectors are shell wildcard patterns matched against full names using
+ * fnmatch(3), where `*' also matches `::' separators. Selectors holding no
+ * wildcard are compared using strcmp(3) only.
+ * Selecting a suite selects its descendants and excluding it excludes them: the
+ * verdict of a suite is given back to the caller so that its descendants
+ * inherit it without being matched at all.
+ *
+ * In addition, the name of a descendant always starts with the name of its
+ * parent suite followed by `::'. A selector which literal prefix, i.e. the part
+ * preceding its first wildcard, differs from this cannot match any descendant
+ * of the suite. When no selector of a kind may match, descendants inherit the
+ * suite verdict for this kind as well.
+ */
+struct cute_select {
+	const char * pattern;
+	size_t       prefix;
+	bool         glob;
+};
+
+/* Node is selected by an include selector. */
+#define CUTE_MATCH_INCL      (1U << 2)
+/* Include selectors need not be matched against descendants. */
+#define CUTE_MATCH_INCL_DONE (1U << 3)
+/* Exclude selectors need not be matched against descendants. */
+#define CUTE_MATCH_EXCL_DONE (1U << 4)
+/* Node is cute_config::name or one of its descendants. */
+#define CUTE_MATCH_NAME      (1U << 5)
+
+#define CUTE_MATCH_INHR      (CUTE_MATCH_INCL | \
+                              CUTE_MATCH_INCL_DONE | \
+                              CUTE_MATCH_EXCL_DONE | \
+                              CUTE_MATCH_NAME)
+
+static struct cute_select * cute_select_incl;
+static unsigned int         cute_select_incl_nr;
+static struct cute_select * cute_select_excl;
+static unsigned int         cute_select_excl_nr;
+
+static bool
+cute_select_match(const struct cute_select * sel, const char * name)
+{
+	cute_assert_intern(sel);
+	cute_assert_intern(sel->pattern);
+	cute_assert_intern(name);
+
+	if (!sel->glob)
+		return !strcmp(sel->pattern, name);
+
+	if (strncmp(sel->pattern, name, sel->prefix))
+		return false;
+
+	return !fnmatch(sel->pattern, name, 0);
+}
+
+/* Tell whether pattern may name a descendant of the suite named name. */
+static bool
+cute_match_below(const char * pattern,
+                 size_t       prefix,
+                 const char * name,
+                 size_t       len)
+{
+	cute_assert_intern(pattern);
+	cute_assert_intern(name);
+
+	size_t c;
+
+	if (prefix <= len)
+		return !strncmp(pattern, name, prefix);
+
+	if (strncmp(pattern, name, len))
+		return false;
+
+	for (c = len; (c < (len + 2)) && (c < prefix); c++) {
+		if (pattern[c] != ':')
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+cute_select_match_below(const struct cute_select * sel,
+                        const char *               name,
+                        size_t                     len)
+{
+	cute_assert_intern(sel);
+	cute_assert_intern(sel->pattern);
+
+	if (!sel->glob && (sel->prefix <= (len + 2)))
+		/* Too short to name a descendant. */
+		return false;
+
+	return cute_match_below(sel->pattern, sel->prefix, name, len);
+}
+
+static bool
+cute_select_match_any(const struct cute_select * sels,
+                      unsigned int               nr,
+                      const char *               name)
+{
+	unsigned int s;
+
+	for (s = 0; s < nr; s++) {
+		if (cute_select_match(&sels[s], name))
+			return true;
+	}
+
+	return false;
+}
+
+static bool
+cute_select_match_any_below(const struct cute_select * sels,
+                            unsigned int               nr,
+                            const char *               name,
+                            size_t                     len)
 {
-	cute_run_assert_intern(run);
+	unsigned int s;
+
+	for (s = 0; s < nr; s++) {
+		if (cute_select_match_below(&sels[s], name, len))
+			return true;
+	}
+
+	return false;
+}
+
+static struct cute_select *
+cute_select_build(const char * const * patterns, unsigned int * nr)
+{
+	cute_assert_intern(nr);
+
+	struct cute_select * sels;
+	unsigned int         s;
+
+	*nr = 0;
+	if (!patterns || !patterns[0])
+		return NULL;
+
+	while (patterns[*nr])
+		(*nr)++;
+
+	sels = cute_malloc(*nr * sizeof(sels[0]));
+	for (s = 0; s < *nr; s++) {
+		const char * pattern = patterns[s];
+
+		cute_assert_intern(pattern[0]);
+
+		sels[s].pattern = pattern;
+		sels[s].prefix = strcspn(pattern, "*?[\\");
+		sels[s].glob = !!pattern[sels[s].prefix];
+	}
+
+	return sels;
+}
+
+static bool
+cute_match_pattern(const char * name, bool test)
+{
+	if ((cute_the_config->shards > 1) || cute_the_config->rerun_path) {
+		/*
+		 * Only select test cases: enabling a test turns its parent
+		 * suites on.
+		 */
+		if (!test)
+			return false;
+
+		if ((cute_the_config->shards > 1) &&
+		    ((cute_match_hash(name) % cute_the_config->shards) !=
+		     cute_the_config->shard))
+			return false;
+
+		if (cute_the_config->rerun_path && !cute_hist_probe_fail(name))
+			return false;
+	}
 
 	if (cute_pattern) {
 		cute_assert_intern(cute_pattern[0]);
 		cute_assert_intern(strnlen(cute_pattern,
 		                           CUTE_MATCH_SIZE) < CUTE_MATCH_SIZE);
 
-		return cute_regex_match(&cute_regex, run->name);
+		if (cute_literal)
+			return cute_icase ? !!strcasestr(name, cute_pattern) :
+			                    !!strstr(name, cute_pattern);
+
+		return cute_regex_match(&cute_regex, name);
 	}
 
 	return true;
 }
 
+/*
+ * Compute selection flags of the hierarchy node which full name is given
+ * according to flags of its parent, NULL for the top-level suite. Nodes must be
+ * given in pre-order and descendants of a node flagged with CUTE_MATCH_PRUNE
+ * must not be given at all.
+ */
+unsigned int
+cute_match_name(const char * name, bool test, const unsigned int * parent)
+{
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+	cute_assert_intern(!parent || !(*parent & CUTE_MATCH_PRUNE));
+	cute_config_assert_intern(cute_the_config);
+
+	const char * sel = cute_the_config->name;
+	bool         named = true;
+	unsigned int flags;
+	size_t       len = strlen(name);
+
+	if (parent)
+		flags = *parent & CUTE_MATCH_INHR;
+	else
+		flags = (!cute_select_incl_nr ?
+		         (CUTE_MATCH_INCL | CUTE_MATCH_INCL_DONE) : 0) |
+		        (!cute_select_excl_nr ? CUTE_MATCH_EXCL_DONE : 0) |
+		        (!sel ? CUTE_MATCH_NAME : 0);
+
+	if (!(flags & CUTE_MATCH_NAME)) {
+		if (!strcmp(name, sel))
+			flags |= CUTE_MATCH_NAME;
+		else if (test ||
+		         !cute_match_below(sel, strlen(sel), name, len))
+			return CUTE_MATCH_PRUNE;
+		else
+			/* An ancestor of the selected node. */
+			named = false;
+	}
+
+	if (!(flags & CUTE_MATCH_INCL_DONE)) {
+		if (cute_select_match_any(cute_select_incl,
+		                          cute_select_incl_nr,
+		                          name))
+			flags |= CUTE_MATCH_INCL | CUTE_MATCH_INCL_DONE;
+		else if (!test &&
+		         !cute_select_match_any_below(cute_select_incl,
+		                                      cute_select_incl_nr,
+		                                      name,
+		                                      len))
+			return CUTE_MATCH_PRUNE;
+	}
+
+	if (!(flags & CUTE_MATCH_EXCL_DONE)) {
+		if (cute_select_match_any(cute_select_excl,
+		                          cute_select_excl_nr,
+		                          name))
+			return CUTE_MATCH_PRUNE;
+		else if (!test &&
+		         !cute_select_match_any_below(cute_select_excl,
+		                                      cute_select_excl_nr,
+		                                      name,
+		                                      len))
+			flags |= CUTE_MATCH_EXCL_DONE;
+	}
+
+	if (named &&
+	    (flags & CUTE_MATCH_INCL) &&
+	    cute_match_pattern(name, test))
+		flags |= CUTE_MATCH_SELECT;
+
+	return flags;
+}
+
 int
 cute_match_init(const char * pattern, bool icase)
 {
+	cute_config_assert_intern(cute_the_config);
+
 	if (pattern) {
 		cute_assert_intern(pattern[0]);
 		cute_assert_intern(strnlen(pattern, CUTE_MATCH_SIZE) <
 		                   CUTE_MATCH_SIZE);
 
-		int err;
+		/*
+		 * An unanchored expression without any special character
+		 * matches names holding it as a plain substring: skip regex
+		 * engine.
+		 */
+		cute_literal = !strpbrk(pattern, ".[]()*+?{}|^$\\");
+		if (!cute_literal) {
+			int err;
 
-		err = cute_regex_init(&cute_regex, pattern, icase);
-		if (err)
-			return err;
+			err = cute_regex_init(&cute_regex, pattern, icase);
+			if (err)
+				return err;
+		}
 
+		cute_icase = icase;
 		cute_pattern = pattern;
 	}
 
+	cute_select_incl = cute_select_build(cute_the_config->includes,
+	                                     &cute_select_incl_nr);
+	cute_select_excl = cute_select_build(cute_the_config->excludes,
+	                                     &cute_select_excl_nr);
+
 	return 0;
 }
 
 void
 cute_match_fini(void)
 {
+	cute_free(cute_select_excl);
+	cute_select_excl = NULL;
+	cute_select_excl_nr = 0;
+
+	cute_free(cute_select_incl);
+	cute_select_incl = NULL;
+	cute_select_incl_nr = 0;
+
 	if (cute_pattern) {
 		cute_assert_intern(cute_pattern[0]);
 		cute_assert_intern(strnlen(cute_pattern,
 		                           CUTE_MATCH_SIZE) < CUTE_MATCH_SIZE);
 
 		cute_pattern = NULL;
-		cute_regex_fini(&cute_regex);
+		if (!cute_literal)
+			cute_regex_fini(&cute_regex);
 	}
 }
 
-struct cute_iter *
-cute_base_create_iter(const struct cute_base * base)
+bool
+cute_base_init_iter(const struct cute_base * base, struct cute_iter * iter)
 {
 	cute_base_assert_intern(base);
+	cute_assert_intern(iter);
 
-	return base->ops->iter(base);
+	return base->ops->iter(base, iter);
 }
 
 struct cute_run *
@@ -158,34 +458,29 @@ cute_base_foreach(const struct cute_base * root,
 	cute_base_assert_intern(root);
 	cute_assert_intern(process);
 
-	struct cute_iter * iter;
-	struct cute_stack  stk;
+	/* Traversal state lives onto the stack: one iterator per depth level. */
+	struct cute_iter iters[CUTE_DEPTH_MAX];
+	unsigned int     cnt = 0;
 
-	iter = cute_base_create_iter(root);
-	if (!iter) {
+	if (!cute_base_init_iter(root, &iters[0])) {
 		process(root, CUTE_ONCE_VISIT, data);
 		return;
 	}
 
-	cute_assert_intern(iter);
-
-	cute_stack_init(&stk);
-	cute_stack_push(&stk, iter);
-
+	cnt++;
 	process(root, CUTE_BEGIN_VISIT, data);
 
 	do {
+		struct cute_iter *       iter = &iters[cnt - 1];
 		const struct cute_base * base;
 
-		iter = cute_stack_peek(&stk);
-		cute_assert_intern(iter);
 		if (!cute_iter_end(iter)) {
 			enum cute_visit visit = CUTE_ONCE_VISIT;
 
 			base = cute_iter_const_next(iter);
-			iter = cute_base_create_iter(base);
-			if (iter) {
-				cute_stack_push(&stk, iter);
+			cute_assert(cnt < CUTE_DEPTH_MAX);
+			if (cute_base_init_iter(base, &iters[cnt])) {
+				cnt++;
 				visit = CUTE_BEGIN_VISIT;
 			}
 
@@ -197,11 +492,8 @@ cute_base_foreach(const struct cute_base * root,
 		cute_assert_intern(base);
 		process(base, CUTE_END_VISIT, data);
 
-		cute_stack_pop(&stk);
-		cute_iter_destroy(iter);
-	} while (cute_stack_count(&stk));
-
-	cute_stack_fini(&stk);
+		cnt--;
+	} while (cnt);
 }
 
 struct cute_elf {
@@ -557,25 +849,28 @@ cute_load_build_id(void)
 	}
 }
 
+/*
+ * Build tool, flags and configuration properties are parsed out of the
+ * executable ELF sections, which requires to open and walk the whole file.
+ * Since only a few reports need them, defer loading till first use.
+ */
+static bool cute_elf_loaded;
+
 void
-cute_load_props(const char * package, const char * version)
+cute_load_elf_props(void)
 {
 	const char *    path;
 	struct cute_elf elf;
-	int             err __cute_unused;
-
-	path = (const char *)getauxval(AT_EXECFN);
-	cute_assert_intern(path);
+	struct timespec tspec;
 
-	err = gethostname(cute_hostname, sizeof(cute_hostname));
-	cute_assert_intern(!err);
+	if (cute_elf_loaded)
+		return;
 
-	if (package && package[0])
-		cute_package = package;
-	if (version && version[0])
-		cute_package_version = version;
+	cute_elf_loaded = true;
+	cute_prof_start(&tspec);
 
-	cute_load_build_id();
+	path = (const char *)getauxval(AT_EXECFN);
+	cute_assert_intern(path);
 
 	if (cute_open_elf(&elf, path))
 		goto err;
@@ -585,6 +880,8 @@ cute_load_props(const char * package, const char * version)
 
 	cute_close_elf(&elf);
 
+	cute_prof_stage("elf", &tspec);
+
 	return;
 
 close:
@@ -593,14 +890,73 @@ err:
 	cute_error("'%s': cannot load ELF properties.\n", path);
 }
 
+void
+cute_load_props(const char * package, const char * version)
+{
+	int err __cute_unused;
+
+	err = gethostname(cute_hostname, sizeof(cute_hostname));
+	cute_assert_intern(!err);
+
+	if (package && package[0])
+		cute_package = package;
+	if (version && version[0])
+		cute_package_version = version;
+
+	cute_load_build_id();
+}
+
 void
 cute_unload_props(void)
 {
 	free(cute_build_id);
+	cute_build_id = NULL;
+
+	if (!cute_elf_loaded)
+		return;
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcast-qual"
 	free((void *)cute_build_tool.data);
 	free((void *)cute_build_flags.data);
 	free((void *)cute_build_conf.data);
 #pragma GCC diagnostic pop
+	memset(&cute_build_tool, 0, sizeof(cute_build_tool));
+	memset(&cute_build_flags, 0, sizeof(cute_build_flags));
+	memset(&cute_build_conf, 0, sizeof(cute_build_conf));
+
+	cute_elf_loaded = false;
+}
+
+/*
+ * Startup profiling.
+ *
+ * When cute_config::profile is enabled, time spent into each initialization
+ * stage, deferred ones included, is measured using the monotonic clock and
+ * printed onto standard error.
+ */
+bool cute_prof;
+
+void
+cute_prof_stage(const char * stage, struct timespec * start)
+{
+	cute_assert_intern(stage);
+	cute_assert_intern(start);
+
+	struct timespec now;
+	struct timespec diff;
+
+	if (!cute_prof)
+		return;
+
+	cute_gettime(&now);
+	cute_diff_tspec(&diff, start, &now);
+
+	fprintf(cute_iodir_stderr ? cute_iodir_stderr : stderr,
+	        "%s: startup: %-8s %9ld ns\n",
+	        program_invocation_short_name,
+	        stage,
+	        (diff.tv_sec * 1000000000L) + diff.tv_nsec);
+
+	*start = now;
 }
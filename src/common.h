@@ -24,6 +24,12 @@
 #define CUTE_NAME_MAX_LEN      (96U)
 #define CUTE_FULL_NAME_MAX_LEN (192U)
 
+/*
+ * Maximum depth of a test hierarchy, i.e. the number of single character
+ * names a full name may hold given that "::" separates them.
+ */
+#define CUTE_DEPTH_MAX         ((CUTE_FULL_NAME_MAX_LEN + 2U) / 3U)
+
 enum cute_state {
 	CUTE_INIT_STATE,
 	CUTE_OFF_STATE,
@@ -59,6 +65,7 @@ enum cute_issue {
 	CUTE_FAIL_ISSUE,
 	CUTE_EXCP_ISSUE,
 	CUTE_OFF_ISSUE,
+	CUTE_CUT_ISSUE,
 	CUTE_ISSUE_NR
 };
 
@@ -124,6 +131,9 @@ cute_issue_label(enum cute_issue issue);
 
 #define cute_config_assert(_conf) \
 	cute_assert(_conf); \
+	cute_assert((_conf)->shards); \
+	cute_assert((_conf)->shard < (_conf)->shards); \
+	cute_assert((_conf)->repeat); \
 	cute_config_assert_report((_conf)->reports); \
 	cute_config_assert_tty((_conf)->tty)
 
@@ -161,14 +171,22 @@ extern char *               cute_build_id;
 extern struct cute_prop     cute_build_tool;
 extern struct cute_prop     cute_build_flags;
 extern struct cute_prop     cute_build_conf;
-extern sigjmp_buf           cute_jmp_env;
+extern __thread sigjmp_buf  cute_jmp_env;
 extern unsigned int         cute_run_nr;
 
 extern int
 cute_match_parse(const char * pattern);
 
-extern bool
-cute_match_run(const struct cute_run * run);
+extern unsigned int
+cute_match_hash(const char * name);
+
+/* Node is selected. */
+#define CUTE_MATCH_SELECT (1U << 0)
+/* Neither node nor any of its descendants may be selected. */
+#define CUTE_MATCH_PRUNE  (1U << 1)
+
+extern unsigned int
+cute_match_name(const char * name, bool test, const unsigned int * parent);
 
 extern int
 cute_match_init(const char * pattern, bool icase);
@@ -176,8 +194,8 @@ cute_match_init(const char * pattern, bool icase);
 extern void
 cute_match_fini(void);
 
-extern struct cute_iter *
-cute_base_create_iter(const struct cute_base * base);
+extern bool
+cute_base_init_iter(const struct cute_base * base, struct cute_iter * iter);
 
 struct cute_run;
 
@@ -206,4 +224,19 @@ cute_load_props(const char * package, const char * version);
 extern void
 cute_unload_props(void);
 
+extern void
+cute_load_elf_props(void);
+
+extern bool cute_prof;
+
+static inline void
+cute_prof_start(struct timespec * start)
+{
+	if (cute_prof)
+		cute_gettime(start);
+}
+
+extern void
+cute_prof_stage(const char * stage, struct timespec * start);
+
 #endif /* _CUTE_COMMON_H */
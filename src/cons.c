@@ -7,6 +7,7 @@
 
 #include "cons.h"
 #include "suite.h"
+#include "bisect.h"
 #include "iodir.h"
 #include <ctype.h>
 #include <string.h>
@@ -101,6 +102,11 @@ cute_cons_report_head(const struct cute_cons_report * report)
 	        bold, (int)ttl_len, title, reg,
 	        post_len, hrule);
 
+	if (cute_the_config->shuffle)
+		fprintf(report->stdio,
+		        "Running tests in random order using %sseed %u%s.\n\n",
+		        bold, cute_the_config->seed, reg);
+
 	cute_free(title);
 	cute_free(hrule);
 }
@@ -208,7 +214,7 @@ cute_cons_report_suite_sumup(const struct cute_cons_report * report,
         const struct cute_stats * stats = total ? &suite->sums : &suite->stats;
 
 	color = cute_term_issue_color(term, issue);
-	cute_diff_tspec(&diff, &suite->super.begin, &suite->super.end);
+	cute_span_diff(&diff, &suite->super.times.exec);
 
 	cute_term_depth_printf(term,
 	                       report->stdio,
@@ -237,7 +243,7 @@ cute_cons_report_suite_sumup(const struct cute_cons_report * report,
 	                       stats->total,
 	                       term->regular);
 
-	if (issue != CUTE_OFF_ISSUE)
+	if (stats->exec)
 		fprintf(report->stdio,
 		        "%s"
 		        CUTE_CONS_REPORT_NAME_FMT
@@ -307,6 +313,105 @@ cute_cons_report_process_sumup(struct cute_run * run,
 	}
 }
 
+static void
+cute_cons_report_process_repeat(struct cute_run * run,
+                                enum cute_visit   visit,
+                                void *            data)
+{
+	const struct cute_cons_report * report =
+		(const struct cute_cons_report *)data;
+	const struct cute_term *        term = &report->term;
+	const struct cute_repeat *      rep = &run->repeat;
+	int                             width = report->colnr -
+	                                        cute_term_indent_width(
+	                                                run->depth) -
+	                                        CUTE_CONS_REPORT_REPEAT_WIDTH;
+
+	switch (visit) {
+	case CUTE_BEGIN_VISIT:
+		cute_term_depth_printf(term,
+		                       report->stdio,
+		                       run->depth,
+		                       "%s%s%s\n",
+		                       term->blue,
+		                       run->base->name,
+		                       term->regular);
+		break;
+
+	case CUTE_ONCE_VISIT:
+		if (!rep->runs)
+			break;
+
+		cute_term_depth_printf(term,
+		                       report->stdio,
+		                       run->depth,
+		                       CUTE_CONS_REPORT_NAME_FMT
+		                       " %s" CUTE_CONS_REPORT_PASS_FMT
+		                       " %s" CUTE_CONS_REPORT_FAIL_FMT "%s"
+		                       " " CUTE_CONS_REPORT_USEC_FMT
+		                       " " CUTE_CONS_REPORT_USEC_FMT
+		                       " " CUTE_CONS_REPORT_USEC_FMT
+		                       " " CUTE_CONS_REPORT_USEC_FMT
+		                       "\n",
+		                       width, width, run->base->name,
+		                       term->green, rep->pass,
+		                       rep->fail ? term->red : term->fore,
+		                       rep->fail,
+		                       term->regular,
+		                       rep->min / 1000000UL, rep->min % 1000000UL,
+		                       rep->med / 1000000UL, rep->med % 1000000UL,
+		                       rep->p95 / 1000000UL, rep->p95 % 1000000UL,
+		                       rep->max / 1000000UL, rep->max % 1000000UL);
+		break;
+
+	case CUTE_END_VISIT:
+		break;
+
+	default:
+		__cute_unreachable();
+	}
+}
+
+/*
+ * Show per test pass / fail counts and duration distribution of iterations
+ * run in repeat mode (see cute_config::repeat).
+ */
+static void
+cute_cons_report_repeat(const struct cute_cons_report * report,
+                        const struct cute_suite_run *   suite)
+{
+	char * hrule;
+
+	fprintf(report->stdio,
+	        "\n"
+	        "%s"
+	        "%-*s"
+	        " " CUTE_CONS_REPORT_PASS_HEAD
+	        " " CUTE_CONS_REPORT_FAIL_HEAD
+	        " " CUTE_CONS_REPORT_MIN_HEAD
+	        " " CUTE_CONS_REPORT_MED_HEAD
+	        " " CUTE_CONS_REPORT_P95_HEAD
+	        " " CUTE_CONS_REPORT_MAX_HEAD
+	        "%s"
+	        "\n",
+	        report->term.bold,
+	        report->colnr - CUTE_CONS_REPORT_REPEAT_WIDTH,
+	        CUTE_CONS_REPORT_NAME_HEAD,
+	        report->term.regular);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+	cute_run_foreach((struct cute_run *)suite,
+	                 cute_cons_report_process_repeat,
+	                 (void *)report);
+#pragma GCC diagnostic pop
+
+	hrule = cute_cons_report_create_hrule(CUTE_CONS_REPORT_TABLE_SYM,
+	                                      report->colnr);
+	fprintf(report->stdio, "%s\n", hrule);
+	cute_free(hrule);
+}
+
 static void
 cute_cons_report_results(const struct cute_cons_report * report,
                          const struct cute_suite_run *   suite)
@@ -347,6 +452,13 @@ cute_cons_report_results(const struct cute_cons_report * report,
 		                suite->sums.exec);
 		break;
 
+	case CUTE_CUT_ISSUE:
+		blen = snprintf(body,
+		                sz,
+		                "%u test(s) CUT SHORT",
+		                suite->sums.cut);
+		break;
+
 	case CUTE_OFF_ISSUE:
 		blen = snprintf(body, sz, "All tests DISABLED");
 		break;
@@ -355,6 +467,17 @@ cute_cons_report_results(const struct cute_cons_report * report,
 		__cute_unreachable();
 	}
 
+	if (suite->sums.cut && (issue != CUTE_CUT_ISSUE) && (blen < (int)sz))
+		blen += snprintf(&body[blen],
+		                 sz - (size_t)blen,
+		                 ", %u CUT SHORT",
+		                 suite->sums.cut);
+	if (suite->sums.cached && (blen < (int)sz))
+		blen += snprintf(&body[blen],
+		                 sz - (size_t)blen,
+		                 ", %u CACHED",
+		                 suite->sums.cached);
+
 	if (blen > len)
 		len = blen;
 
@@ -428,8 +551,20 @@ cute_cons_report_sumup(const struct cute_cons_report * report,
 
 	cute_cons_report_suite_sumup(report, suite, true);
 
+	if (cute_the_config->repeat > 1)
+		cute_cons_report_repeat(report, suite);
 
 	cute_cons_report_results(report, suite);
+
+	if (cute_bisect_victim)
+		fprintf(report->stdio,
+		        "%sOrder dependency:%s %s fails when run after %s "
+		        "(seed %u).\n\n",
+		        report->term.bold,
+		        report->term.regular,
+		        cute_bisect_victim->name,
+		        cute_bisect_culprit->name,
+		        cute_the_config->seed);
 }
 
 void
@@ -588,7 +723,16 @@ cute_cons_report_on_info(const struct cute_cons_report * report,
 		fprintf(report->stdio, "%sTimeout%s:   inherited\n", bold, reg);
 		break;
 	default:
-		fprintf(report->stdio, "%sTimeout%s:   %u\n", bold, reg, tmout);
+		if (tmout & CUTE_MSEC_TMOUT_FLAG)
+			fprintf(report->stdio,
+			        "%sTimeout%s:   %u ms\n",
+			        bold, reg,
+			        tmout & ~CUTE_MSEC_TMOUT_FLAG);
+		else
+			fprintf(report->stdio,
+			        "%sTimeout%s:   %u\n",
+			        bold, reg,
+			        tmout);
 	}
 	fprintf(report->stdio,
 	        "%1$s#Suites%2$s:   %3$u\n"
@@ -604,6 +748,8 @@ cute_cons_report_on_info(const struct cute_cons_report * report,
 	        cute_hostname,
 	        cute_build_id ? cute_build_id : "none");
 
+	cute_load_elf_props();
+
 	fprintf(report->stdio,
 	        "\n### %sBuild configuration%s ###\n\n",
 	        bold, reg);
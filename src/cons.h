@@ -63,6 +63,17 @@
 	 (1 + CUTE_CONS_REPORT_EXCP_WIDTH) + \
 	 (1 + CUTE_CONS_REPORT_EXEC_WIDTH) + \
 	 (1 + CUTE_CONS_REPORT_TOTAL_WIDTH))
+#define CUTE_CONS_REPORT_MIN_HEAD    " MIN(s.us)"
+#define CUTE_CONS_REPORT_MED_HEAD    " MED(s.us)"
+#define CUTE_CONS_REPORT_P95_HEAD    " P95(s.us)"
+#define CUTE_CONS_REPORT_MAX_HEAD    " MAX(s.us)"
+#define CUTE_CONS_REPORT_USEC_FMT    "%3lu.%06lu"
+#define CUTE_CONS_REPORT_USEC_WIDTH  ((int) \
+				      sizeof(CUTE_CONS_REPORT_MIN_HEAD) - 1)
+#define CUTE_CONS_REPORT_REPEAT_WIDTH \
+	((1 + CUTE_CONS_REPORT_PASS_WIDTH) + \
+	 (1 + CUTE_CONS_REPORT_FAIL_WIDTH) + \
+	 (4 * (1 + CUTE_CONS_REPORT_USEC_WIDTH)))
 
 #define CUTE_CONS_NAME_COLS_MIN      12
 
@@ -0,0 +1,260 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Per test code coverage slicing.
+ *
+ * When CUTe is built with CONFIG_CUTE_COVERAGE enabled, it is linked against
+ * the gcov runtime library so that coverage counters of test programs built
+ * using the --coverage compiler option may be driven from within CUTe.
+ *
+ * Counters are cleared by __gcov_reset() right before a test setup fixture
+ * runs and written by __gcov_dump() right after its teardown fixture
+ * completes. Data files of each test are written under a directory of its own
+ * by pointing GCOV_PREFIX environment variable to
+ * <cute_config::cov_path>/<full test name> where '::' separators are
+ * replaced by '/'. Running gcov(1) against this directory gives the files and
+ * lines the test covered.
+ *
+ * Finally, the manifest.txt file written under cute_config::cov_path maps
+ * full names of tests to the directory holding their data files, one test per
+ * line.
+ *
+ * As gcov does, counters dumped into existing data files are merged with
+ * counters these files hold: cute_config::cov_path should be cleaned up
+ * between runs.
+ *
+ * Tests of threaded suites run concurrently share counters: coverage is not
+ * recorded for them.
+ */
+
+#include "cov.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(CONFIG_CUTE_COVERAGE)
+
+extern void __gcov_reset(void);
+extern void __gcov_dump(void);
+
+#endif /* defined(CONFIG_CUTE_COVERAGE) */
+
+#define CUTE_COV_MANIFEST "manifest.txt"
+
+static char * cute_cov_path;
+static char * cute_cov_prefix;
+static bool   cute_cov_started;
+
+/*
+ * Build the data file directory of the given test, relative to
+ * cute_config::cov_path.
+ */
+static void
+cute_cov_build_dir(char * dir, const char * name)
+{
+	cute_assert_intern(dir);
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+
+	while (*name) {
+		if ((name[0] == ':') && (name[1] == ':')) {
+			*dir++ = '/';
+			name += 2;
+			continue;
+		}
+
+		*dir++ = *name++;
+	}
+
+	*dir = '\0';
+}
+
+void
+cute_cov_start(void)
+{
+	cute_assert_intern(!cute_cov_started);
+
+	if (!cute_cov_path || cute_run_is_shared())
+		return;
+
+#if defined(CONFIG_CUTE_COVERAGE)
+	__gcov_reset();
+#endif /* defined(CONFIG_CUTE_COVERAGE) */
+
+	cute_cov_started = true;
+}
+
+void
+cute_cov_stop(const struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+
+	char   prefix[PATH_MAX];
+	size_t len;
+
+	if (!cute_cov_started)
+		return;
+
+	cute_cov_started = false;
+
+	len = strlen(cute_cov_path);
+	if ((len + 1 + strlen(run->name) + 1) > sizeof(prefix)) {
+		cute_error("'%s': cannot dump coverage data: %s.\n",
+		           run->name,
+		           strerror(ENAMETOOLONG));
+		return;
+	}
+
+	memcpy(prefix, cute_cov_path, len);
+	prefix[len] = '/';
+	cute_cov_build_dir(&prefix[len + 1], run->name);
+
+	if (setenv("GCOV_PREFIX", prefix, 1)) {
+		cute_error("'%s': cannot dump coverage data: %s.\n",
+		           run->name,
+		           strerror(errno));
+		return;
+	}
+
+#if defined(CONFIG_CUTE_COVERAGE)
+	__gcov_dump();
+#endif /* defined(CONFIG_CUTE_COVERAGE) */
+
+	if (cute_cov_prefix)
+		setenv("GCOV_PREFIX", cute_cov_prefix, 1);
+	else
+		unsetenv("GCOV_PREFIX");
+}
+
+static void
+cute_cov_store_run(struct cute_run * run,
+                   enum cute_visit   visit,
+                   void *            data)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(data);
+
+	char        dir[CUTE_FULL_NAME_MAX_LEN + 1];
+	char *      path;
+	struct stat st;
+	int         err;
+
+	if ((visit != CUTE_ONCE_VISIT) ||
+	    (run->base->ops != &cute_test_ops) ||
+	    run->cached)
+		return;
+
+	cute_cov_build_dir(dir, run->name);
+
+	path = cute_malloc(strlen(cute_cov_path) + 1 + strlen(dir) + 1);
+	sprintf(path, "%s/%s", cute_cov_path, dir);
+	err = stat(path, &st);
+	cute_free(path);
+
+	/* No data dumped for this test, i.e. not run or run concurrently. */
+	if (err || !S_ISDIR(st.st_mode))
+		return;
+
+	fprintf((FILE *)data, "%s %s\n", run->name, dir);
+}
+
+static void
+cute_cov_store_all(FILE * stdio, void * data)
+{
+	cute_assert_intern(stdio);
+
+	cute_run_foreach((struct cute_run *)data, cute_cov_store_run, stdio);
+}
+
+/*
+ * Manifest file is replaced atomically so that tools never load a partial
+ * manifest.
+ */
+void
+cute_cov_store(struct cute_run * root)
+{
+	cute_run_assert_intern(root);
+
+	char * path;
+	int    err;
+
+	if (!cute_cov_path)
+		return;
+
+	path = cute_malloc(strlen(cute_cov_path) +
+	                   sizeof("/" CUTE_COV_MANIFEST));
+	sprintf(path, "%s/" CUTE_COV_MANIFEST, cute_cov_path);
+
+	err = cute_store_file(path, cute_cov_store_all, root);
+	if (err)
+		cute_error("'%s': cannot store coverage manifest: %s.\n",
+		           path,
+		           strerror(-err));
+
+	cute_free(path);
+}
+
+#if defined(CONFIG_CUTE_COVERAGE)
+
+int
+cute_cov_load(const char * dir)
+{
+	cute_assert_intern(dir);
+	cute_assert_intern(dir[0]);
+	cute_assert_intern(!cute_cov_path);
+
+	const char * prefix;
+	int          err;
+
+	if (mkdir(dir, 0755) && (errno != EEXIST)) {
+		err = -errno;
+		cute_error("'%s': cannot create coverage directory: %s.\n",
+		           dir,
+		           strerror(-err));
+		return err;
+	}
+
+	cute_cov_path = cute_malloc(strlen(dir) + 1);
+	strcpy(cute_cov_path, dir);
+
+	/* Restored once each test data have been dumped. */
+	prefix = getenv("GCOV_PREFIX");
+	if (prefix) {
+		cute_cov_prefix = cute_malloc(strlen(prefix) + 1);
+		strcpy(cute_cov_prefix, prefix);
+	}
+
+	return 0;
+}
+
+#else  /* !defined(CONFIG_CUTE_COVERAGE) */
+
+int
+cute_cov_load(const char * dir)
+{
+	cute_assert_intern(dir);
+	cute_assert_intern(dir[0]);
+
+	cute_error("'%s': cannot record coverage: %s.\n",
+	           dir,
+	           strerror(ENOTSUP));
+
+	return -ENOTSUP;
+}
+
+#endif /* defined(CONFIG_CUTE_COVERAGE) */
+
+void
+cute_cov_unload(void)
+{
+	cute_free(cute_cov_prefix);
+	cute_free(cute_cov_path);
+
+	cute_cov_prefix = NULL;
+	cute_cov_path = NULL;
+}
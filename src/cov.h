@@ -0,0 +1,28 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_COV_H
+#define _CUTE_COV_H
+
+#include "run.h"
+
+extern void
+cute_cov_start(void);
+
+extern void
+cute_cov_stop(const struct cute_run * run);
+
+extern void
+cute_cov_store(struct cute_run * root);
+
+extern int
+cute_cov_load(const char * dir);
+
+extern void
+cute_cov_unload(void);
+
+#endif /* _CUTE_COV_H */
@@ -31,6 +31,14 @@ libcute.so-objs    += \
 	shared/init.o \
 	shared/suite.o \
 	shared/test.o \
+	shared/pool.o \
+	shared/hist.o \
+	shared/cache.o \
+	shared/bisect.o \
+	shared/perf.o \
+	shared/heap.o \
+	shared/leak.o \
+	shared/cov.o \
 	shared/tap.o \
 	shared/xml.o \
 	shared/terse.o \
@@ -49,11 +57,32 @@ libcute.so-ldflags := $(filter-out -fpie -fPIE,$(common-ldflags)) \
                       -shared -fpic -Bsymbolic -Wl,-soname,libcute.so
 libcute.so-pkgconf := libelf
 
+ifneq ($(call kconf_is_enabled,CUTE_COVERAGE),)
+# Test executables built with --coverage link against libgcov by themselves.
+libcute.so-ldflags += -lgcov
+endif # ifneq ($(call kconf_is_enabled,CUTE_COVERAGE),)
+
+# Heap tracking helper: interposes allocator entry points of test programs
+# linked against it or preloading it.
+solibs                  += libcute-heap.so
+libcute-heap.so-objs    := shared/malloc.o
+libcute-heap.so-cflags  := $(libcute.so-cflags)
+libcute-heap.so-ldflags := $(filter-out -fpie -fPIE,$(common-ldflags)) \
+                           -shared -fpic -Wl,-soname,libcute-heap.so
+
 arlibs             := libcute.a
 libcute.a-objs     += \
 	static/init.o \
 	static/suite.o \
 	static/test.o \
+	static/pool.o \
+	static/hist.o \
+	static/cache.o \
+	static/bisect.o \
+	static/perf.o \
+	static/heap.o \
+	static/leak.o \
+	static/cov.o \
 	static/tap.o \
 	static/xml.o \
 	static/terse.o \
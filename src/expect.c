@@ -15,8 +15,8 @@
  * Assertion mock expectation handling
  ******************************************************************************/
 
-sigjmp_buf cute_expect_assert_env;
-bool       cute_expect_assert;
+__thread sigjmp_buf cute_expect_assert_env;
+__thread bool       cute_expect_assert;
 
 bool
 cute_expect_check_assert(void)
@@ -145,8 +145,8 @@ struct cute_expect_queue {
 	struct cute_expect * tail;
 };
 
-static struct cute_expect_queue cute_expect_sched;
-static struct cute_expect_queue cute_expect_done;
+static __thread struct cute_expect_queue cute_expect_sched;
+static __thread struct cute_expect_queue cute_expect_done;
 
 static bool
 cute_expect_empty(const struct cute_expect_queue * queue)
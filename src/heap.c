@@ -0,0 +1,101 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Per test heap allocation tracking.
+ *
+ * Allocator interposition lives into the libcute-heap.so helper library (see
+ * malloc.c) so that only test programs linked against it or preloading it get
+ * their allocator interposed. It is referenced weakly: heap tracking is
+ * refused at initialization time when the helper is not loaded.
+ *
+ * glibc lazily allocates a few resources it keeps for the lifetime of the
+ * process, the first time they are needed:
+ * - standard output and error buffers, at first output: these are excluded
+ *   automatically once a test completes,
+ * - timezone data, at first tzset(3) call or local time conversion ; when the
+ *   TZ environment variable is unset, localtime(3), ctime(3), mktime(3) and
+ *   strftime(3) re-allocate the timezone name at each call whereas their
+ *   reentrant variants do not,
+ * - stacks and thread local storage descriptors of exited threads, cached for
+ *   reuse by subsequent pthread_create(3) calls.
+ * Test programs should get these allocated before tracking starts, e.g. from
+ * within a constructor function, or exclude them using cute_heap_ignore().
+ */
+
+#include "heap.h"
+#include "run.h"
+#include <string.h>
+
+extern const struct cute_heap_ops cute_heap_helper __attribute__((weak));
+
+static const struct cute_heap_ops * cute_heap_ops;
+
+void
+cute_heap_ignore(const void * ptr)
+{
+	if (cute_heap_ops)
+		cute_heap_ops->ignore(ptr);
+}
+
+int
+cute_heap_load(void)
+{
+	if (!&cute_heap_helper) {
+		cute_error("cannot track heap allocations: "
+		           "libcute-heap.so not loaded.\n");
+		return -ENOTSUP;
+	}
+
+	cute_heap_ops = &cute_heap_helper;
+
+	return 0;
+}
+
+void
+cute_heap_start(void)
+{
+	cute_config_assert_intern(cute_the_config);
+
+	if (!cute_the_config->heap)
+		return;
+
+	cute_assert_intern(cute_heap_ops);
+
+	cute_heap_ops->start(cute_run_is_shared());
+}
+
+void
+cute_heap_resume(void)
+{
+	if (cute_the_config->heap)
+		cute_heap_ops->resume();
+}
+
+void
+cute_heap_suspend(void)
+{
+	if (cute_the_config->heap)
+		cute_heap_ops->suspend();
+}
+
+void
+cute_heap_stop(struct cute_heap * heap)
+{
+	cute_assert_intern(heap);
+
+	if (!cute_the_config->heap) {
+		memset(heap, 0, sizeof(*heap));
+		return;
+	}
+
+	/* Standard I/O buffers are allocated once for the process lifetime. */
+	cute_heap_ops->ignore(stdout->_IO_buf_base);
+	cute_heap_ops->ignore(stderr->_IO_buf_base);
+
+	cute_heap_ops->stop(heap);
+}
@@ -0,0 +1,58 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_HEAP_H
+#define _CUTE_HEAP_H
+
+#include "common.h"
+
+/*
+ * Heap allocations of a test run, from the start of its setup fixture till the
+ * end of its teardown fixture. Fields are meaningful only when tracked is set.
+ *
+ * Bytes are given as requested by callers: allocator overhead is not
+ * accounted for.
+ */
+struct cute_heap {
+	bool          tracked;
+	unsigned long allocs;
+	unsigned long bytes;
+	unsigned long peak;
+	unsigned long leaks;
+};
+
+/*
+ * Operations of the heap tracking helper library, i.e. libcute-heap.so. Test
+ * programs must be linked against it or have it preloaded for heap tracking to
+ * be available.
+ */
+struct cute_heap_ops {
+	void (*start)(bool shared);
+	void (*resume)(void);
+	void (*suspend)(void);
+	void (*stop)(struct cute_heap * heap);
+	void (*ignore)(const void * ptr);
+};
+
+extern const struct cute_heap_ops cute_heap_helper;
+
+extern int
+cute_heap_load(void);
+
+extern void
+cute_heap_start(void);
+
+extern void
+cute_heap_resume(void);
+
+extern void
+cute_heap_suspend(void);
+
+extern void
+cute_heap_stop(struct cute_heap * heap);
+
+#endif /* _CUTE_HEAP_H */
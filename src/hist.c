@@ -0,0 +1,520 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Results of a previous run.
+ *
+ * Test case records are loaded from a JUnit XML report as generated by the
+ * xml reporter or from a cute-report(1) database. Only <testcase> elements are
+ * considered: their classname and name attributes are joined to rebuild test
+ * full names, time attribute gives the duration of the recorded run and status
+ * attribute its outcome.
+ *
+ * This is not a general purpose XML parser: both formats are known to hold
+ * attributes enclosed within double quotes and names made of C identifiers
+ * that need no unescaping.
+ *
+ * Failed test records may also be loaded from a TAP report as generated by the
+ * tap reporter. As the top-level suite is not named into TAP output, names
+ * rebuilt from subtests are relative to the top-level suite.
+ */
+
+#include "hist.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+struct cute_hist_rec {
+	char *        name;
+	unsigned long usec;
+};
+
+struct cute_hist {
+	struct cute_hist_rec * recs;
+	unsigned int           nr;
+	unsigned int           max;
+	bool                   fails;
+};
+
+/* Durations of tests recorded into cute_config::hist_path. */
+static struct cute_hist cute_hist_times = { .fails = false };
+
+/* Tests recorded as failed into cute_config::rerun_path. */
+static struct cute_hist cute_hist_fails = { .fails = true };
+
+static int
+cute_hist_cmp_name(const void * first, const void * second)
+{
+	return strcmp(((const struct cute_hist_rec *)first)->name,
+	              ((const struct cute_hist_rec *)second)->name);
+}
+
+static int
+cute_hist_cmp_key(const void * key, const void * rec)
+{
+	return strcmp((const char *)key,
+	              ((const struct cute_hist_rec *)rec)->name);
+}
+
+static const struct cute_hist_rec *
+cute_hist_probe(const struct cute_hist * hist, const char * name)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+
+	if (!hist->nr)
+		return NULL;
+
+	return bsearch(name,
+	               hist->recs,
+	               hist->nr,
+	               sizeof(hist->recs[0]),
+	               cute_hist_cmp_key);
+}
+
+bool
+cute_hist_probe_time(const char * name, unsigned long * usec)
+{
+	cute_assert_intern(usec);
+
+	const struct cute_hist_rec * rec;
+
+	rec = cute_hist_probe(&cute_hist_times, name);
+	if (!rec)
+		return false;
+
+	*usec = rec->usec;
+
+	return true;
+}
+
+bool
+cute_hist_probe_fail(const char * name)
+{
+	cute_assert_intern(name);
+
+	const char * rel;
+
+	if (cute_hist_probe(&cute_hist_fails, name))
+		return true;
+
+	/* Retry with name relative to top-level suite for TAP records. */
+	rel = strstr(name, "::");
+	if (!rel)
+		return false;
+
+	return !!cute_hist_probe(&cute_hist_fails, rel + 2);
+}
+
+/*
+ * Find the value of attribute which name is given in argument within the
+ * [start, end[ element tag.
+ */
+static const char *
+cute_hist_parse_attr(const char * start,
+                     const char * end,
+                     const char * attr,
+                     size_t *     len)
+{
+	cute_assert_intern(start);
+	cute_assert_intern(end > start);
+	cute_assert_intern(attr);
+	cute_assert_intern(attr[0]);
+	cute_assert_intern(len);
+
+	size_t       alen = strlen(attr);
+	const char * str = start;
+
+	while ((size_t)(end - str) > (alen + 2)) {
+		const char * val;
+		const char * quote;
+
+		str = memmem(str, (size_t)(end - str), attr, alen);
+		if (!str)
+			return NULL;
+
+		val = str + alen;
+		if ((str == start) ||
+		    !isspace((unsigned char)str[-1]) ||
+		    ((end - val) < 2) ||
+		    (val[0] != '=') ||
+		    (val[1] != '"')) {
+			str = val;
+			continue;
+		}
+
+		val += 2;
+		quote = memchr(val, '"', (size_t)(end - val));
+		if (!quote)
+			return NULL;
+
+		*len = (size_t)(quote - val);
+
+		return val;
+	}
+
+	return NULL;
+}
+
+/* Parse a time attribute value given in seconds as "<sec>.<usec>". */
+static bool
+cute_hist_parse_time(const char * str, size_t len, unsigned long * usec)
+{
+	cute_assert_intern(str);
+	cute_assert_intern(usec);
+
+	unsigned long sec = 0;
+	unsigned long frac = 0;
+	unsigned int  digits = 0;
+	size_t        c = 0;
+
+	if (!len || !isdigit((unsigned char)str[0]))
+		return false;
+
+	while ((c < len) && isdigit((unsigned char)str[c]))
+		sec = (sec * 10) + (unsigned long)(str[c++] - '0');
+
+	if ((c < len) && (str[c] == '.')) {
+		c++;
+		while ((c < len) && isdigit((unsigned char)str[c])) {
+			if (digits < 6) {
+				frac = (frac * 10) +
+				       (unsigned long)(str[c] - '0');
+				digits++;
+			}
+			c++;
+		}
+	}
+
+	if (c != len)
+		return false;
+
+	while (digits++ < 6)
+		frac *= 10;
+
+	*usec = (sec * 1000000UL) + frac;
+
+	return true;
+}
+
+/*
+ * Register a new record which name is made of the given prefix and name
+ * joined with "::". Return NULL when resulting name is too long.
+ */
+static struct cute_hist_rec *
+cute_hist_add(struct cute_hist * hist,
+              const char *       prefix,
+              size_t             plen,
+              const char *       name,
+              size_t             nlen)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(!plen || prefix);
+	cute_assert_intern(name);
+	cute_assert_intern(nlen);
+
+	struct cute_hist_rec * rec;
+	size_t                 sep = plen ? 2 : 0;
+
+	if ((plen + sep + nlen) > CUTE_FULL_NAME_MAX_LEN)
+		return NULL;
+
+	if (hist->nr == hist->max) {
+		hist->max = hist->max ? (2 * hist->max) : 64;
+		hist->recs = cute_realloc(hist->recs,
+		                          hist->max * sizeof(hist->recs[0]));
+	}
+
+	rec = &hist->recs[hist->nr++];
+	rec->name = cute_malloc(plen + sep + nlen + 1);
+	if (plen) {
+		memcpy(rec->name, prefix, plen);
+		rec->name[plen] = ':';
+		rec->name[plen + 1] = ':';
+	}
+	memcpy(&rec->name[plen + sep], name, nlen);
+	rec->name[plen + sep + nlen] = '\0';
+	rec->usec = 0;
+
+	return rec;
+}
+
+static bool
+cute_hist_match_attr(const char * val, size_t len, const char * str)
+{
+	return (len == strlen(str)) && !memcmp(val, str, len);
+}
+
+static void
+cute_hist_parse_testcase(struct cute_hist * hist,
+                         const char *       start,
+                         const char *       end)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(start);
+	cute_assert_intern(end > start);
+
+	const char *           name;
+	size_t                 nlen;
+	const char *           cls;
+	size_t                 clen;
+	const char *           attr;
+	size_t                 alen;
+	struct cute_hist_rec * rec;
+	unsigned long          usec = 0;
+
+	name = cute_hist_parse_attr(start, end, "name", &nlen);
+	if (!name || !nlen)
+		return;
+	cls = cute_hist_parse_attr(start, end, "classname", &clen);
+	if (!cls || !clen)
+		return;
+
+	if (hist->fails) {
+		attr = cute_hist_parse_attr(start, end, "status", &alen);
+		if (!attr ||
+		    !(cute_hist_match_attr(attr, alen, "failure") ||
+		      cute_hist_match_attr(attr, alen, "error")))
+			return;
+	}
+	else {
+		attr = cute_hist_parse_attr(start, end, "time", &alen);
+		if (!attr || !cute_hist_parse_time(attr, alen, &usec))
+			return;
+	}
+
+	rec = cute_hist_add(hist, cls, clen, name, nlen);
+	if (rec)
+		rec->usec = usec;
+}
+
+static void
+cute_hist_parse_xml(struct cute_hist * hist, const char * data, size_t size)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(data);
+
+	static const char tag[] = "<testcase";
+	const char *      end = &data[size];
+
+	while (true) {
+		const char * close;
+
+		data = memmem(data, (size_t)(end - data), tag, sizeof(tag) - 1);
+		if (!data)
+			break;
+
+		data += sizeof(tag) - 1;
+		close = memchr(data, '>', (size_t)(end - data));
+		if (!close)
+			break;
+
+		if (isspace((unsigned char)data[0]))
+			cute_hist_parse_testcase(hist, data, close);
+
+		data = close;
+	}
+}
+
+#define CUTE_HIST_TAP_DEPTH_MAX (32U)
+
+/*
+ * Parse a TAP report and register "not ok" test points.
+ *
+ * Subtests are nested using 4 spaces indentation. Names of enclosing subtests
+ * are tracked by nesting level so that names relative to the top-level suite
+ * may be rebuilt. YAML diagnostic blocks are skipped since they may hold
+ * arbitrary captured output.
+ */
+static void
+cute_hist_parse_tap(struct cute_hist * hist, char * data)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(data);
+
+	static const char sub[] = "# Subtest: ";
+	static const char nok[] = "not ok ";
+	const char *      names[CUTE_HIST_TAP_DEPTH_MAX] = { NULL, };
+	char              path[CUTE_FULL_NAME_MAX_LEN + 1];
+	size_t            yaml = SIZE_MAX;
+	char *            line;
+
+	for (line = strtok(data, "\n"); line; line = strtok(NULL, "\n")) {
+		size_t       indent = strspn(line, " ");
+		const char * str = &line[indent];
+		unsigned int lvl = (unsigned int)(indent / 4);
+		size_t       len = 0;
+		unsigned int l;
+
+		if (yaml != SIZE_MAX) {
+			if ((indent == yaml) && !strcmp(str, "..."))
+				yaml = SIZE_MAX;
+			continue;
+		}
+
+		if (!strcmp(str, "---")) {
+			yaml = indent;
+			continue;
+		}
+
+		if (lvl >= CUTE_HIST_TAP_DEPTH_MAX)
+			continue;
+
+		if (!strncmp(str, sub, sizeof(sub) - 1)) {
+			names[lvl] = &str[sizeof(sub) - 1];
+			continue;
+		}
+
+		if (strncmp(str, nok, sizeof(nok) - 1))
+			continue;
+
+		/* Skip test point number and separator. */
+		str += sizeof(nok) - 1;
+		str += strspn(str, "0123456789");
+		if (strncmp(str, " - ", 3))
+			continue;
+		str += 3;
+
+		for (l = 0; l < lvl; l++) {
+			size_t nlen;
+
+			if (!names[l])
+				break;
+
+			nlen = strlen(names[l]);
+			if ((len + nlen + 2) > CUTE_FULL_NAME_MAX_LEN)
+				break;
+			memcpy(&path[len], names[l], nlen);
+			len += nlen;
+			path[len++] = ':';
+			path[len++] = ':';
+		}
+		if (l != lvl)
+			continue;
+
+		cute_hist_add(hist,
+		              len ? path : NULL,
+		              len ? len - 2 : 0,
+		              str,
+		              strcspn(str, " #"));
+	}
+}
+
+static void
+cute_hist_parse(struct cute_hist * hist, char * data, size_t size)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(data);
+
+	unsigned int r;
+	unsigned int cnt;
+
+	if (data[strspn(data, " \t\r\n")] == '<')
+		cute_hist_parse_xml(hist, data, size);
+	else if (hist->fails)
+		cute_hist_parse_tap(hist, data);
+
+	if (!hist->nr)
+		return;
+
+	qsort(hist->recs, hist->nr, sizeof(hist->recs[0]), cute_hist_cmp_name);
+
+	/*
+	 * A database may hold multiple records for the same test when it has
+	 * been populated from multiple configurations: keep the longest one.
+	 */
+	for (r = 1, cnt = 1; r < hist->nr; r++) {
+		struct cute_hist_rec * last = &hist->recs[cnt - 1];
+		struct cute_hist_rec * rec = &hist->recs[r];
+
+		if (!strcmp(last->name, rec->name)) {
+			if (rec->usec > last->usec)
+				last->usec = rec->usec;
+			cute_free(rec->name);
+			continue;
+		}
+
+		hist->recs[cnt++] = *rec;
+	}
+
+	hist->nr = cnt;
+}
+
+static int
+cute_hist_load_file(struct cute_hist * hist,
+                    const char *       path,
+                    const char *       what)
+{
+	cute_assert_intern(hist);
+	cute_assert_intern(!hist->recs);
+	cute_assert_intern(!hist->nr);
+	cute_assert_intern(path);
+	cute_assert_intern(path[0]);
+	cute_assert_intern(what);
+
+	char * data;
+	size_t size;
+	int    err;
+
+	err = cute_load_file(path, &data, &size);
+	if (err) {
+		cute_error("'%s': cannot load %s file: %s.\n",
+		           path,
+		           what,
+		           strerror(-err));
+		return err;
+	}
+
+	cute_hist_parse(hist, data, size);
+
+	cute_free(data);
+
+	return 0;
+}
+
+static void
+cute_hist_unload_file(struct cute_hist * hist)
+{
+	cute_assert_intern(hist);
+
+	unsigned int r;
+
+	for (r = 0; r < hist->nr; r++)
+		cute_free(hist->recs[r].name);
+
+	cute_free(hist->recs);
+
+	hist->recs = NULL;
+	hist->nr = 0;
+	hist->max = 0;
+}
+
+int
+cute_hist_load(const char * path)
+{
+	return cute_hist_load_file(&cute_hist_times, path, "history");
+}
+
+void
+cute_hist_unload(void)
+{
+	cute_hist_unload_file(&cute_hist_times);
+}
+
+int
+cute_hist_load_fails(const char * path)
+{
+	return cute_hist_load_file(&cute_hist_fails, path, "report");
+}
+
+void
+cute_hist_unload_fails(void)
+{
+	cute_hist_unload_file(&cute_hist_fails);
+}
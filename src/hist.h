@@ -0,0 +1,31 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_HIST_H
+#define _CUTE_HIST_H
+
+#include "common.h"
+
+extern bool
+cute_hist_probe_time(const char * name, unsigned long * usec);
+
+extern int
+cute_hist_load(const char * path);
+
+extern void
+cute_hist_unload(void);
+
+extern bool
+cute_hist_probe_fail(const char * name);
+
+extern int
+cute_hist_load_fails(const char * path);
+
+extern void
+cute_hist_unload_fails(void);
+
+#endif /* _CUTE_HIST_H */
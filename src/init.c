@@ -7,6 +7,10 @@
 
 #include "report.h"
 #include "suite.h"
+#include "hist.h"
+#include "cache.h"
+#include "cov.h"
+#include "heap.h"
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
@@ -29,6 +33,344 @@ cute_config_enable_debug(struct cute_config * config)
 	config->debug = true;
 }
 
+static void
+cute_config_enable_snapshot(struct cute_config * config)
+{
+	cute_assert_intern(config);
+
+	config->snapshot = true;
+}
+
+static int
+cute_config_parse_count(const char *   arg,
+                        const char *   what,
+                        unsigned int * count)
+{
+	cute_assert_intern(arg);
+	cute_assert_intern(what);
+	cute_assert_intern(count);
+
+	unsigned long val;
+	char *        end;
+
+	errno = 0;
+	val = strtoul(arg, &end, 10);
+	if (!arg[0] || (arg[0] == '-') || *end || errno ||
+	    !val || (val > UINT_MAX)) {
+		cute_error("invalid '%s' %s.\n", arg, what);
+		return -EINVAL;
+	}
+
+	*count = (unsigned int)val;
+
+	return 0;
+}
+
+static int
+cute_config_setup_jobs(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+
+	return cute_config_parse_count(arg, "number of jobs", &config->jobs);
+}
+
+static int
+cute_config_setup_threads(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+
+	return cute_config_parse_count(arg,
+	                               "number of threads",
+	                               &config->threads);
+}
+
+static int
+cute_config_setup_shard(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(arg);
+
+	const char *  str = arg;
+	unsigned long idx;
+	unsigned long cnt;
+	char *        end;
+
+	errno = 0;
+	idx = strtoul(str, &end, 10);
+	if ((end == str) || (str[0] == '-') || (*end != '/') || errno)
+		goto inval;
+
+	str = end + 1;
+	cnt = strtoul(str, &end, 10);
+	if ((end == str) || (str[0] == '-') || *end || errno)
+		goto inval;
+
+	if (!idx || !cnt || (cnt > UINT_MAX) || (idx > cnt))
+		goto inval;
+
+	config->shard = (unsigned int)(idx - 1);
+	config->shards = (unsigned int)cnt;
+
+	return 0;
+
+inval:
+	cute_error("invalid '%s' shard specification.\n", arg);
+	return -EINVAL;
+}
+
+static int
+cute_config_setup_hist(struct cute_config * config, const char * path)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(path);
+
+	if (!path[0]) {
+		cute_error("invalid empty history pathname.\n");
+		return -EINVAL;
+	}
+
+	config->hist_path = path;
+
+	return 0;
+}
+
+static int
+cute_config_setup_rerun(struct cute_config * config, const char * path)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(path);
+
+	if (!path[0]) {
+		cute_error("invalid empty report pathname.\n");
+		return -EINVAL;
+	}
+
+	config->rerun_path = path;
+
+	return 0;
+}
+
+static int
+cute_config_setup_name(struct cute_config * config, const char * name)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(name);
+
+	size_t len;
+
+	len = strnlen(name, CUTE_FULL_NAME_MAX_LEN + 1);
+	if (!len || (len > CUTE_FULL_NAME_MAX_LEN)) {
+		cute_error("selected test or suite name missing or too long.\n");
+		return -EINVAL;
+	}
+
+	config->name = name;
+
+	return 0;
+}
+
+static int
+cute_config_add_select(const char ** sels,
+                       unsigned int * nr,
+                       const char *   pattern)
+{
+	cute_assert_intern(sels);
+	cute_assert_intern(nr);
+	cute_assert_intern(pattern);
+
+	size_t len;
+
+	len = strnlen(pattern, CUTE_FULL_NAME_MAX_LEN + 1);
+	if (!len || (len > CUTE_FULL_NAME_MAX_LEN)) {
+		cute_error("selector pattern missing or too long.\n");
+		return -EINVAL;
+	}
+
+	sels[(*nr)++] = pattern;
+	sels[*nr] = NULL;
+
+	return 0;
+}
+
+static int
+cute_config_setup_cache(struct cute_config * config, const char * path)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(path);
+
+	if (!path[0]) {
+		cute_error("invalid empty cache directory pathname.\n");
+		return -EINVAL;
+	}
+
+	config->cache_path = path;
+
+	return 0;
+}
+
+static int
+cute_config_setup_cov(struct cute_config * config, const char * path)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(path);
+
+	if (!path[0]) {
+		cute_error("invalid empty coverage directory pathname.\n");
+		return -EINVAL;
+	}
+
+	config->cov_path = path;
+
+	return 0;
+}
+
+static int
+cute_config_setup_fail_fast(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+
+	if (!arg) {
+		config->fail_fast = 1;
+		return 0;
+	}
+
+	return cute_config_parse_count(arg,
+	                               "number of failures",
+	                               &config->fail_fast);
+}
+
+static int
+cute_config_setup_repeat(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(arg);
+
+	return cute_config_parse_count(arg,
+	                               "number of repetitions",
+	                               &config->repeat);
+}
+
+static void
+cute_config_enable_until_fail(struct cute_config * config)
+{
+	cute_assert_intern(config);
+
+	config->until_fail = true;
+}
+
+static int
+cute_config_setup_shuffle(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+
+	unsigned long val;
+	char *        end;
+
+	config->shuffle = true;
+
+	if (!arg) {
+		struct timespec now;
+
+		/* Make up a seed that differs from one run to another. */
+		cute_getstamp(&now);
+		config->seed = (unsigned int)now.tv_sec ^
+		               (unsigned int)now.tv_nsec ^
+		               (unsigned int)getpid();
+		return 0;
+	}
+
+	errno = 0;
+	val = strtoul(arg, &end, 10);
+	if (!arg[0] || (arg[0] == '-') || *end || errno || (val > UINT_MAX)) {
+		cute_error("invalid '%s' shuffle seed.\n", arg);
+		return -EINVAL;
+	}
+
+	config->seed = (unsigned int)val;
+
+	return 0;
+}
+
+static void
+cute_config_enable_bisect(struct cute_config * config)
+{
+	cute_assert_intern(config);
+
+	config->bisect = true;
+}
+
+static void
+cute_config_enable_profile(struct cute_config * config)
+{
+	cute_assert_intern(config);
+
+	config->profile = true;
+}
+
+static void
+cute_config_enable_heap(struct cute_config * config)
+{
+	cute_assert_intern(config);
+
+	config->heap = true;
+}
+
+static void
+cute_config_enable_leaks(struct cute_config * config)
+{
+	cute_assert_intern(config);
+
+	config->leaks = true;
+}
+
+static int
+cute_config_setup_cpu_tmout(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+
+	return cute_config_parse_count(arg,
+	                               "CPU time budget",
+	                               &config->cpu_tmout);
+}
+
+static int
+cute_config_setup_perfs(struct cute_config * config, const char * arg)
+{
+	cute_assert_intern(config);
+	cute_assert_intern(arg);
+
+	const char * name = arg;
+	unsigned int perfs = 0;
+
+	while (true) {
+		size_t       len = strcspn(name, ",");
+		unsigned int c;
+
+		for (c = 0; c < CUTE_PERF_NR; c++) {
+			const char * str = cute_perf_name(c);
+
+			if ((len == strlen(str)) && !memcmp(name, str, len))
+				break;
+		}
+
+		if (c == CUTE_PERF_NR) {
+			cute_error("invalid '%s' performance counters.\n", arg);
+			return -EINVAL;
+		}
+
+		perfs |= (1U << c);
+
+		name += len;
+		if (!*name)
+			break;
+		name++;
+	}
+
+	config->perfs = perfs;
+
+	return 0;
+}
+
 static int
 cute_config_parse_tty(const char * arg, enum cute_config_tty * tty)
 {
@@ -231,33 +573,100 @@ cute_init(struct cute_config * config,
 	cute_config_assert(config);
 	cute_assert(!cute_the_config);
 
-	int err;
+	struct timespec start;
+	struct timespec tspec;
+	int             err;
+
+	cute_prof = config->profile;
+	cute_prof_start(&start);
+	tspec = start;
 
 	setlocale(LC_ALL, "");
+	cute_prof_stage("locale", &tspec);
 
 	err = cute_iodir_init();
 	if (err)
 		return err;
+	cute_prof_stage("stdio", &tspec);
 
 	cute_load_props(package, version);
+	cute_prof_stage("props", &tspec);
 
 	err = cute_config_load(config);
 	if (err)
 		goto fini;
+	cute_prof_stage("config", &tspec);
 
 	cute_the_config = config;
 
-	cute_run_init_sigs();
+	if (config->heap) {
+		err = cute_heap_load();
+		if (err)
+			goto release;
+	}
+
+	if (config->hist_path) {
+		err = cute_hist_load(config->hist_path);
+		if (err)
+			goto release;
+		cute_prof_stage("history", &tspec);
+	}
+
+	if (config->rerun_path) {
+		err = cute_hist_load_fails(config->rerun_path);
+		if (err)
+			goto unload;
+		cute_prof_stage("rerun", &tspec);
+	}
+
+	if (config->cache_path) {
+		err = cute_cache_load(config->cache_path);
+		if (err)
+			goto unload_fails;
+		cute_prof_stage("cache", &tspec);
+	}
+
+	if (config->cov_path) {
+		err = cute_cov_load(config->cov_path);
+		if (err)
+			goto unload_cache;
+		cute_prof_stage("coverage", &tspec);
+	}
+
+	err = cute_run_init_sigs();
+	if (err) {
+		cute_error("cannot setup signal handling: %s (%d).\n",
+		           strerror(-err),
+		           -err);
+		goto unload_cov;
+	}
+	cute_prof_stage("signals", &tspec);
+
+	cute_prof_stage("init", &start);
 
 	cute_run_nr = 0;
+	cute_run_fails = 0;
 
 	return 0;
 
+unload_cov:
+	cute_cov_unload();
+unload_cache:
+	cute_cache_unload();
+unload_fails:
+	cute_hist_unload_fails();
+unload:
+	cute_hist_unload();
+release:
+	cute_the_config = NULL;
+	cute_report_release();
 fini:
 	cute_unload_props();
 
 	cute_iodir_fini();
 
+	cute_prof = false;
+
 	return err;
 }
 
@@ -266,6 +675,11 @@ cute_fini(void)
 {
 	cute_run_fini_sigs();
 
+	cute_cov_unload();
+	cute_cache_unload();
+	cute_hist_unload_fails();
+	cute_hist_unload();
+
 	cute_report_release();
 
 	cute_unload_props();
@@ -273,6 +687,8 @@ cute_fini(void)
 	cute_the_config = NULL;
 
 	cute_iodir_fini();
+
+	cute_prof = false;
 }
 
 #define CUTE_HELP \
@@ -294,6 +710,48 @@ cute_fini(void)
 "                                       exception handling nor timeouts.\n" \
 "    -i|--icase                      -- Ignore case when matching against\n" \
 "                                       <PATTERN>.\n" \
+"    -j<JOBS>|--jobs=<JOBS>          -- Run up to <JOBS> tests concurrently.\n" \
+"    -T<THREADS>|--threads=<THREADS> -- Run up to <THREADS> threaded suite tests\n" \
+"                                       concurrently.\n" \
+"    -S|--snapshot                   -- Run suite setup fixtures once and fork\n" \
+"                                       inheriting tests from resulting state.\n" \
+"    -H<SHARD>|--shard=<SHARD>       -- Run the subset of tests assigned to\n" \
+"                                       <SHARD>.\n" \
+"    -P<HIST>|--history=<HIST>       -- Dispatch longest tests first according\n" \
+"                                       to durations recorded into <HIST>.\n" \
+"    -R<PREV>|--rerun-failed=<PREV>  -- Run tests recorded as failed into\n" \
+"                                       <PREV>.\n" \
+"    -I<GLOB>|--include=<GLOB>       -- Select suites and tests matching <GLOB>\n" \
+"                                       and their descendants (may be repeated).\n" \
+"    -X<GLOB>|--exclude=<GLOB>       -- Deselect suites and tests matching <GLOB>\n" \
+"                                       and their descendants (may be repeated).\n" \
+"    -N<NAME>|--name=<NAME>          -- Select the suite or test which full name\n" \
+"                                       is <NAME> and its descendants only.\n" \
+"    -C<CACHE>|--cache=<CACHE>       -- Skip tests passed by previous runs of\n" \
+"                                       the same build according to <CACHE>.\n" \
+"    -f[<MAX>]|--fail-fast[=<MAX>]   -- Stop running tests once <MAX> tests\n" \
+"                                       failed.\n" \
+"    -r<N>|--repeat=<N>              -- Run each test <N> times and report\n" \
+"                                       flakiness and durations statistics.\n" \
+"    -u|--until-fail                 -- Stop repeating a test at its first\n" \
+"                                       failure.\n" \
+"    -O[<SEED>]|--shuffle[=<SEED>]   -- Run tests in random order computed\n" \
+"                                       according to <SEED>.\n" \
+"    -B|--bisect-order               -- Search for the smallest pair of tests\n" \
+"                                       reproducing a shuffled run failure.\n" \
+"    -c<MSEC>|--cpu-timeout=<MSEC>   -- Interrupt tests consuming more than\n" \
+"                                       <MSEC> milliseconds of CPU time.\n" \
+"    -p|--profile                    -- Print time spent into each startup\n" \
+"                                       stage onto standard error.\n" \
+"    -E<EVENTS>|--perf-counters=<EVENTS>\n" \
+"                                    -- Sample <EVENTS> performance counters\n" \
+"                                       while running each test.\n" \
+"    -m|--heap-check                 -- Track heap allocations of each test and\n" \
+"                                       fail tests leaking memory.\n" \
+"    -L|--leak-check                 -- Fail tests leaving file descriptors open\n" \
+"                                       or threads running behind.\n" \
+"    -g<COV>|--coverage=<COV>        -- Dump code coverage data of each test\n" \
+"                                       under <COV>.\n" \
 "    -s|--silent                     -- Enable `silent' reporter to silence all\n" \
 "                                       console output.\n" \
 "    -t[<COLOR>]|--terse[=<COLOR>]   -- Enable `terse' reporter with minimal\n" \
@@ -309,6 +767,34 @@ cute_fini(void)
 "Where:\n" \
 "    NAME    -- Full name used to select a single suite or test ;\n" \
 "               by default, the top-level suite is selected.\n" \
+"    JOBS    -- maximum number of tests run concurrently within separate worker\n" \
+"               processes ; by default, tests are run sequentially.\n" \
+"    THREADS -- maximum number of threaded suite tests run concurrently within\n" \
+"               the runner process ; by default, tests are run sequentially.\n" \
+"    SHARD   -- `<I>/<N>' where tests are split into <N> disjoint subsets\n" \
+"               according to a hash of their full name and only the <I>th one\n" \
+"               is run, 1 <= <I> <= <N> ; by default, all tests are run.\n" \
+"    HIST    -- pathname to a JUnit XML report or cute-report database holding\n" \
+"               results of a previous run.\n" \
+"    PREV    -- pathname to a JUnit XML report, cute-report database or TAP\n" \
+"               report holding results of a previous run.\n" \
+"    CACHE   -- pathname to a directory where passed tests are recorded per\n" \
+"               executable build ID.\n" \
+"    COV     -- pathname to a directory where gcov data files are dumped per\n" \
+"               test ; requires a coverage enabled CUTe build.\n" \
+"    MAX     -- number of failed or crashed tests after which remaining tests\n" \
+"               are not run ; when unspecified, defaults to 1.\n" \
+"    N       -- number of times each test is run in a row, N >= 1 ; by default,\n" \
+"               tests are run once.\n" \
+"    SEED    -- random test order seed ; when unspecified, a seed is made up\n" \
+"               and shown at the start of the run.\n" \
+"    MSEC    -- CPU time budget given to each test, expressed in milliseconds ;\n" \
+"               by default, tests are not given any CPU time budget.\n" \
+"    EVENTS  -- comma separated list of `instructions', `cycles', `cache-misses',\n" \
+"               `branch-misses', `task-clock' and / or `page-faults' counters.\n" \
+"    GLOB    -- shell wildcard pattern matched against full names where `*'\n" \
+"               also matches `::' separators ; by default, all suites and tests\n" \
+"               are selected.\n" \
 "    PATTERN -- POSIX extended regular expression used to select suites and / or\n" \
 "               tests ; by default, all suites and tests are selected.\n" \
 "    COLOR   -- enforce output colorization when `on', disable it when `off' ;\n" \
@@ -336,23 +822,57 @@ cute_main(int                        argc,
 	enum { INFO, SHOW, RUN, ERR } cmd = ERR;
 	const char *                  match = NULL;
 	bool                          icase = false;
+	const char **                 incl;
+	unsigned int                  incl_nr = 0;
+	const char **                 excl;
+	unsigned int                  excl_nr = 0;
 	int                           ret;
 
+	/* There cannot be more selectors than arguments. */
+	incl = cute_malloc((size_t)argc * sizeof(incl[0]));
+	excl = cute_malloc((size_t)argc * sizeof(excl[0]));
+
 	while (true) {
 		int                        o;
 		static const struct option opts[] = {
-			{ "debug",   no_argument,       NULL, 'd' },
-			{ "icase",   no_argument,       NULL, 'i' },
-			{ "silent",  no_argument,       NULL, 's' },
-			{ "tap",     optional_argument, NULL, 'a' },
-			{ "terse",   optional_argument, NULL, 't' },
-			{ "verbose", optional_argument, NULL, 'v' },
-			{ "xml",     optional_argument, NULL, 'x' },
-			{ "help",    no_argument,       NULL, 'h' },
-			{ NULL,      0,                 NULL, 0 }
+			{ "debug",         no_argument,       NULL, 'd' },
+			{ "icase",         no_argument,       NULL, 'i' },
+			{ "jobs",          required_argument, NULL, 'j' },
+			{ "threads",       required_argument, NULL, 'T' },
+			{ "snapshot",      no_argument,       NULL, 'S' },
+			{ "shard",         required_argument, NULL, 'H' },
+			{ "history",       required_argument, NULL, 'P' },
+			{ "rerun-failed",  required_argument, NULL, 'R' },
+			{ "include",       required_argument, NULL, 'I' },
+			{ "exclude",       required_argument, NULL, 'X' },
+			{ "name",          required_argument, NULL, 'N' },
+			{ "cache",         required_argument, NULL, 'C' },
+			{ "fail-fast",     optional_argument, NULL, 'f' },
+			{ "repeat",        required_argument, NULL, 'r' },
+			{ "until-fail",    no_argument,       NULL, 'u' },
+			{ "shuffle",       optional_argument, NULL, 'O' },
+			{ "bisect-order",  no_argument,       NULL, 'B' },
+			{ "cpu-timeout",   required_argument, NULL, 'c' },
+			{ "profile",       no_argument,       NULL, 'p' },
+			{ "perf-counters", required_argument, NULL, 'E' },
+			{ "heap-check",    no_argument,       NULL, 'm' },
+			{ "leak-check",    no_argument,       NULL, 'L' },
+			{ "coverage",      required_argument, NULL, 'g' },
+			{ "silent",        no_argument,       NULL, 's' },
+			{ "tap",           optional_argument, NULL, 'a' },
+			{ "terse",         optional_argument, NULL, 't' },
+			{ "verbose",       optional_argument, NULL, 'v' },
+			{ "xml",           optional_argument, NULL, 'x' },
+			{ "help",          no_argument,       NULL, 'h' },
+			{ NULL,            0,                 NULL, 0 }
 		};
 
-		o = getopt_long(argc, argv, ":a::dist::v::x::h", opts, NULL);
+		o = getopt_long(argc,
+		                argv,
+		                ":a::dij:T:SH:P:R:I:X:N:C:f::r:uO::Bc:pE:mLg:"
+		                "st::v::x::h",
+		                opts,
+		                NULL);
 		if (o < 0)
 			break;
 
@@ -371,6 +891,100 @@ cute_main(int                        argc,
 			ret = 0;
 			break;
 
+		case 'j':
+			ret = cute_config_setup_jobs(&conf, optarg);
+			break;
+
+		case 'T':
+			ret = cute_config_setup_threads(&conf, optarg);
+			break;
+
+		case 'S':
+			cute_config_enable_snapshot(&conf);
+			ret = 0;
+			break;
+
+		case 'H':
+			ret = cute_config_setup_shard(&conf, optarg);
+			break;
+
+		case 'P':
+			ret = cute_config_setup_hist(&conf, optarg);
+			break;
+
+		case 'R':
+			ret = cute_config_setup_rerun(&conf, optarg);
+			break;
+
+		case 'I':
+			ret = cute_config_add_select(incl, &incl_nr, optarg);
+			if (!ret)
+				conf.includes = incl;
+			break;
+
+		case 'X':
+			ret = cute_config_add_select(excl, &excl_nr, optarg);
+			if (!ret)
+				conf.excludes = excl;
+			break;
+
+		case 'N':
+			ret = cute_config_setup_name(&conf, optarg);
+			break;
+
+		case 'C':
+			ret = cute_config_setup_cache(&conf, optarg);
+			break;
+
+		case 'f':
+			ret = cute_config_setup_fail_fast(&conf, optarg);
+			break;
+
+		case 'r':
+			ret = cute_config_setup_repeat(&conf, optarg);
+			break;
+
+		case 'u':
+			cute_config_enable_until_fail(&conf);
+			ret = 0;
+			break;
+
+		case 'O':
+			ret = cute_config_setup_shuffle(&conf, optarg);
+			break;
+
+		case 'B':
+			cute_config_enable_bisect(&conf);
+			ret = 0;
+			break;
+
+		case 'c':
+			ret = cute_config_setup_cpu_tmout(&conf, optarg);
+			break;
+
+		case 'p':
+			cute_config_enable_profile(&conf);
+			ret = 0;
+			break;
+
+		case 'E':
+			ret = cute_config_setup_perfs(&conf, optarg);
+			break;
+
+		case 'm':
+			cute_config_enable_heap(&conf);
+			ret = 0;
+			break;
+
+		case 'L':
+			cute_config_enable_leaks(&conf);
+			ret = 0;
+			break;
+
+		case 'g':
+			ret = cute_config_setup_cov(&conf, optarg);
+			break;
+
 		case 's':
 			ret = cute_config_enable_silent(&conf);
 			break;
@@ -462,13 +1076,18 @@ cute_main(int                        argc,
 	cute_fini();
 
 out:
+	cute_free(excl);
+	cute_free(incl);
+
 	return !ret ? EXIT_SUCCESS : EXIT_FAILURE;
 
 usage:
 	cute_usage(stderr);
-	return EXIT_FAILURE;
+	ret = -EINVAL;
+	goto out;
 
 help:
 	cute_usage(stdout);
-	return EXIT_SUCCESS;
+	ret = 0;
+	goto out;
 }
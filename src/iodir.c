@@ -12,6 +12,8 @@
 #include <string.h>
 #include <poll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /******************************************************************************
  * Standard I/O text block handling
@@ -69,12 +71,40 @@ cute_iodir_atom_free_data(struct cute_iodir_atom * atom)
 	return &atom->data[atom->busy];
 }
 
+/*
+ * Most tests output nothing at all: blocks are given this shared empty atom
+ * until data is first filled in so that no memory is allocated for them.
+ */
+static struct cute_iodir_atom cute_iodir_empty_atom;
+
+/*
+ * Atoms released by completed runs are kept for reuse by subsequent ones.
+ * Blocks may be filled / released concurrently from within threaded suites,
+ * hence the locking.
+ */
+#define CUTE_IODIR_FREE_ATOMS_MAX (64U)
+
+static pthread_mutex_t          cute_iodir_free_lck = PTHREAD_MUTEX_INITIALIZER;
+static struct cute_iodir_atom * cute_iodir_free_atoms;
+static unsigned int             cute_iodir_free_nr;
+
 static struct cute_iodir_atom *
 cute_iodir_alloc_atom(void)
 {
 	struct cute_iodir_atom * atom;
 
-	atom = cute_malloc(sizeof(*atom));
+	cute_lock(&cute_iodir_free_lck);
+	atom = cute_iodir_free_atoms;
+	if (atom) {
+		cute_assert_intern(cute_iodir_free_nr);
+		cute_iodir_free_atoms = atom->next;
+		cute_iodir_free_nr--;
+	}
+	cute_unlock(&cute_iodir_free_lck);
+
+	if (!atom)
+		atom = cute_malloc(sizeof(*atom));
+
 	atom->next = NULL;
 	atom->busy = 0;
 
@@ -85,11 +115,40 @@ static void
 cute_iodir_free_atom(struct cute_iodir_atom * atom)
 {
 	cute_assert_intern(atom);
+	cute_assert_intern(atom != &cute_iodir_empty_atom);
 	cute_assert_intern(atom->busy <= sizeof(atom->data));
 
+	cute_lock(&cute_iodir_free_lck);
+	if (cute_iodir_free_nr < CUTE_IODIR_FREE_ATOMS_MAX) {
+		atom->next = cute_iodir_free_atoms;
+		cute_iodir_free_atoms = atom;
+		cute_iodir_free_nr++;
+		atom = NULL;
+	}
+	cute_unlock(&cute_iodir_free_lck);
+
 	cute_free(atom);
 }
 
+static void
+cute_iodir_drain_free_atoms(void)
+{
+	struct cute_iodir_atom * atom;
+
+	cute_lock(&cute_iodir_free_lck);
+	atom = cute_iodir_free_atoms;
+	cute_iodir_free_atoms = NULL;
+	cute_iodir_free_nr = 0;
+	cute_unlock(&cute_iodir_free_lck);
+
+	while (atom) {
+		struct cute_iodir_atom * next = atom->next;
+
+		cute_free(atom);
+		atom = next;
+	}
+}
+
 bool
 cute_iodir_is_block_busy(const struct cute_iodir_block * block)
 {
@@ -141,6 +200,44 @@ cute_iodir_print_block(FILE *                          stdio,
 	} while (atom);
 }
 
+size_t
+cute_iodir_block_size(const struct cute_iodir_block * block)
+{
+	cute_assert_intern(block);
+	cute_assert_intern(block->head);
+	cute_assert_intern(block->tail);
+
+	const struct cute_iodir_atom * atom = block->head;
+	size_t                         sz = 0;
+
+	do {
+		sz += cute_iodir_atom_busy_size(atom);
+		atom = atom->next;
+	} while (atom);
+
+	return sz;
+}
+
+void
+cute_iodir_copy_block(const struct cute_iodir_block * block, char * data)
+{
+	cute_assert_intern(block);
+	cute_assert_intern(block->head);
+	cute_assert_intern(block->tail);
+	cute_assert_intern(data);
+
+	const struct cute_iodir_atom * atom = block->head;
+
+	do {
+		size_t sz = cute_iodir_atom_busy_size(atom);
+
+		memcpy(data, cute_iodir_atom_busy_data(atom), sz);
+		data += sz;
+
+		atom = atom->next;
+	} while (atom);
+}
+
 static struct cute_iodir_atom *
 cute_iodir_block_atom(struct cute_iodir_block * block)
 {
@@ -150,6 +247,19 @@ cute_iodir_block_atom(struct cute_iodir_block * block)
 
 	struct cute_iodir_atom * tail = block->tail;
 
+	if (tail == &cute_iodir_empty_atom) {
+		cute_assert_intern(block->head == &cute_iodir_empty_atom);
+		cute_assert_intern(!tail->busy);
+		cute_assert_intern(!tail->next);
+
+		tail = cute_iodir_alloc_atom();
+
+		block->head = tail;
+		block->tail = tail;
+
+		return tail;
+	}
+
 	cute_assert_intern(tail->busy <= sizeof(tail->data));
 	if (tail->busy == sizeof(tail->data)) {
 		struct cute_iodir_atom * atom;
@@ -164,16 +274,39 @@ cute_iodir_block_atom(struct cute_iodir_block * block)
 }
 
 void
-cute_iodir_init_block(struct cute_iodir_block * block)
+cute_iodir_fill_block(struct cute_iodir_block * block,
+                      const char *              data,
+                      size_t                    size)
 {
 	cute_assert_intern(block);
+	cute_assert_intern(block->head);
+	cute_assert_intern(block->tail);
+	cute_assert_intern(data || !size);
 
-	struct cute_iodir_atom * head;
+	while (size) {
+		struct cute_iodir_atom * atom;
+		size_t                   sz;
+
+		atom = cute_iodir_block_atom(block);
+		sz = cute_iodir_atom_free_size(atom);
+		if (sz > size)
+			sz = size;
 
-	head = cute_iodir_alloc_atom();
+		memcpy(cute_iodir_atom_free_data(atom), data, sz);
+		cute_iodir_atom_push_data(atom, sz);
+
+		data += sz;
+		size -= sz;
+	}
+}
+
+void
+cute_iodir_init_block(struct cute_iodir_block * block)
+{
+	cute_assert_intern(block);
 
-	block->head = head;
-	block->tail = head;
+	block->head = &cute_iodir_empty_atom;
+	block->tail = &cute_iodir_empty_atom;
 }
 
 void
@@ -185,6 +318,9 @@ cute_iodir_fini_block(struct cute_iodir_block * block)
 
 	struct cute_iodir_atom * atom = block->head;
 
+	if (atom == &cute_iodir_empty_atom)
+		return;
+
 	do {
 		struct cute_iodir_atom * next = atom->next;
 
@@ -194,28 +330,20 @@ cute_iodir_fini_block(struct cute_iodir_block * block)
 }
 
 /******************************************************************************
- * Standard I/Os collection / redirection handling
+ * Standard I/Os capture backend handling
  ******************************************************************************/
 
-enum cute_iodir_state {
-	CUTE_IODIR_IDLE_STAT,
-	CUTE_IODIR_REDIR_STAT,
-	CUTE_IODIR_FLUSH_STAT,
-	CUTE_IODIR_HALT_STAT
+struct cute_iodir_ops {
+	void (*redirect)(struct cute_iodir_block * stdout_block,
+	                 struct cute_iodir_block * stderr_block);
+	void (*restore)(void);
+	int  (*respawn)(const char ** msg);
+	void (*close)(void);
 };
 
-static int                       cute_iodir_stdout_pipe[2];
 static struct cute_iodir_block * cute_iodir_stdout_block;
-
-static int                       cute_iodir_stderr_pipe[2];
 static struct cute_iodir_block * cute_iodir_stderr_block;
 
-static pthread_mutex_t           cute_iodir_lck;
-static pthread_cond_t            cute_iodir_cond;
-static int                       cute_iodir_notifier;
-static pthread_t                 cute_iodir_thr;
-static enum cute_iodir_state     cute_iodir_stat;
-
 FILE *                           cute_iodir_stdout;
 FILE *                           cute_iodir_stderr;
 
@@ -238,6 +366,29 @@ cute_iodir_dup_stdio(FILE * stdio)
 	return fdopen(fd, "w");
 }
 
+/******************************************************************************
+ * Pipe based standard I/Os capture backend
+ *
+ * Standard output and error file descriptors are pointed to pipes drained by
+ * a dedicated capture thread.
+ ******************************************************************************/
+
+enum cute_iodir_state {
+	CUTE_IODIR_IDLE_STAT,
+	CUTE_IODIR_REDIR_STAT,
+	CUTE_IODIR_FLUSH_STAT,
+	CUTE_IODIR_HALT_STAT
+};
+
+static int                       cute_iodir_stdout_pipe[2];
+static int                       cute_iodir_stderr_pipe[2];
+
+static pthread_mutex_t           cute_iodir_lck;
+static pthread_cond_t            cute_iodir_cond;
+static int                       cute_iodir_notifier;
+static pthread_t                 cute_iodir_thr;
+static enum cute_iodir_state     cute_iodir_stat;
+
 static void
 cute_iodir_notify(void)
 {
@@ -298,9 +449,9 @@ cute_iodir_close_notify(void)
 	cute_assert_intern(errno != EBADF);
 }
 
-void
-cute_iodir_redirect(struct cute_iodir_block * stdout_block,
-                    struct cute_iodir_block * stderr_block)
+static void
+cute_iodir_pipe_redirect(struct cute_iodir_block * stdout_block,
+                         struct cute_iodir_block * stderr_block)
 {
 	cute_assert_intern(stdout_block);
 	cute_assert_intern(stdout_block->head);
@@ -329,8 +480,8 @@ cute_iodir_redirect(struct cute_iodir_block * stdout_block,
 	cute_unlock(&cute_iodir_lck);
 }
 
-void
-cute_iodir_restore(void)
+static void
+cute_iodir_pipe_restore(void)
 {
 	cute_assert_intern(cute_iodir_stdout_pipe[0] >= 0);
 	cute_assert_intern(cute_iodir_stdout_pipe[1] >= 0);
@@ -685,66 +836,52 @@ cute_iodir_close_pipe(int pipe_fds[2], FILE * stdio, int stdfd)
 	close(pipe_fds[1]);
 }
 
-int
-cute_iodir_init(void)
-{
-	const char * msg;
-	int          err;
-	sigset_t     set;
 
-	cute_iodir_stdout = cute_iodir_dup_stdio(stdout);
-	if (!cute_iodir_stdout) {
-		err = -errno;
-		msg = "cannot duplicate stdout";
-		goto err;
-	}
+static int
+cute_iodir_pipe_open(const char ** msg)
+{
+	cute_assert_intern(msg);
 
-	cute_iodir_stderr = cute_iodir_dup_stdio(stderr);
-	if (!cute_iodir_stderr) {
-		err = -errno;
-		msg = "cannot duplicate stderr";
-		goto close_stdout;
-	}
+	int      err;
+	sigset_t set;
 
 	err = cute_iodir_open_pipe(cute_iodir_stdout_pipe, stdout);
 	if (err) {
-		msg = "cannot redirect stdout";
-		goto close_stderr;
+		*msg = "cannot redirect stdout";
+		return err;
 	}
 
 	err = cute_iodir_open_pipe(cute_iodir_stderr_pipe, stderr);
 	if (err) {
-		msg = "cannot redirect stderr";
+		*msg = "cannot redirect stderr";
 		goto close_out_pipe;
 	}
 
 	err = cute_iodir_open_notify();
 	if (err) {
-		msg = "cannot open notification channel";
+		*msg = "cannot open notification channel";
 		goto close_err_pipe;
 	}
 
 	err = cute_lock_init(&cute_iodir_lck);
 	if (err) {
-		msg = "cannot setup locking";
+		*msg = "cannot setup locking";
 		goto close_notify;
 	}
 
 	err = cute_cond_init(&cute_iodir_cond);
 	if (err) {
-		msg = "cannot setup condition variable";
+		*msg = "cannot setup condition variable";
 		goto fini_lock;
 	}
 
 	cute_iodir_stat = CUTE_IODIR_IDLE_STAT;
-	cute_iodir_stdout_block = NULL;
-	cute_iodir_stderr_block = NULL;
 
 	err = sigfillset(&set);
 	cute_assert_intern(!err);
 	err = cute_thr_create(&cute_iodir_thr, &set, cute_iodir_capture, NULL);
 	if (err) {
-		msg = "cannot spawn thread";
+		*msg = "cannot spawn thread";
 		goto fini_cond;
 	}
 
@@ -764,31 +901,80 @@ close_out_pipe:
 	cute_iodir_close_pipe(cute_iodir_stdout_pipe,
 	                      cute_iodir_stdout,
 	                      STDOUT_FILENO);
-close_stderr:
-	fclose(cute_iodir_stderr);
-close_stdout:
-	fclose(cute_iodir_stdout);
-err:
-	cute_error("cannot setup standard I/Os: %s: %s (%d)\n",
-	           msg,
-	           strerror(-err),
-	           -err);
 
 	return err;
 }
 
-void
-cute_iodir_fini(void)
+/*
+ * The capture thread does not survive fork(2) and pipes as well as the
+ * notification channel are shared with the parent process: these are all
+ * re-created here.
+ */
+static int
+cute_iodir_pipe_respawn(const char ** msg)
+{
+	cute_assert_intern(msg);
+
+	int      err;
+	sigset_t set;
+
+	close(cute_iodir_stdout_pipe[0]);
+	close(cute_iodir_stdout_pipe[1]);
+	close(cute_iodir_stderr_pipe[0]);
+	close(cute_iodir_stderr_pipe[1]);
+	cute_iodir_close_notify();
+
+	err = cute_iodir_open_pipe(cute_iodir_stdout_pipe, stdout);
+	if (err) {
+		*msg = "cannot redirect stdout";
+		return err;
+	}
+
+	err = cute_iodir_open_pipe(cute_iodir_stderr_pipe, stderr);
+	if (err) {
+		*msg = "cannot redirect stderr";
+		return err;
+	}
+
+	err = cute_iodir_open_notify();
+	if (err) {
+		*msg = "cannot open notification channel";
+		return err;
+	}
+
+	err = cute_lock_init(&cute_iodir_lck);
+	if (err) {
+		*msg = "cannot setup locking";
+		return err;
+	}
+
+	err = cute_cond_init(&cute_iodir_cond);
+	if (err) {
+		*msg = "cannot setup condition variable";
+		return err;
+	}
+
+	cute_iodir_stat = CUTE_IODIR_IDLE_STAT;
+
+	err = sigfillset(&set);
+	cute_assert_intern(!err);
+	err = cute_thr_create(&cute_iodir_thr, &set, cute_iodir_capture, NULL);
+	if (err) {
+		*msg = "cannot spawn thread";
+		return err;
+	}
+
+	return 0;
+}
+
+static void
+cute_iodir_pipe_close(void)
 {
 	cute_assert_intern(cute_iodir_stat == CUTE_IODIR_IDLE_STAT);
-	cute_assert_intern(cute_iodir_stdout);
 	cute_assert_intern(cute_iodir_stdout_pipe[0] >= 0);
 	cute_assert_intern(cute_iodir_stdout_pipe[1] >= 0);
-	cute_assert_intern(!cute_iodir_stdout_block);
-	cute_assert_intern(cute_iodir_stderr);
 	cute_assert_intern(cute_iodir_stderr_pipe[0] >= 0);
 	cute_assert_intern(cute_iodir_stderr_pipe[1] >= 0);
-	cute_assert_intern(!cute_iodir_stderr_block);
 
 	cute_lock(&cute_iodir_lck);
 	cute_iodir_stat = CUTE_IODIR_HALT_STAT;
@@ -808,7 +994,420 @@ cute_iodir_fini(void)
 	cute_iodir_close_pipe(cute_iodir_stdout_pipe,
 	                      cute_iodir_stdout,
 	                      STDOUT_FILENO);
+}
+
+static const struct cute_iodir_ops cute_iodir_pipe_ops = {
+	.redirect = cute_iodir_pipe_redirect,
+	.restore  = cute_iodir_pipe_restore,
+	.respawn  = cute_iodir_pipe_respawn,
+	.close    = cute_iodir_pipe_close
+};
+
+/******************************************************************************
+ * File based standard I/Os capture backend
+ *
+ * Standard output and error file descriptors are pointed to anonymous memory
+ * backed files, i.e. memfd_create(2) or O_TMPFILE ones. Content written by a
+ * test is read back from these files with pread(2) once it completes, then
+ * files are truncated for the next one.
+ *
+ * This requires no capture thread, no synchronization with it, and cannot
+ * stall a test because of pipe capacity.
+ ******************************************************************************/
+
+static int cute_iodir_stdout_file = -1;
+static int cute_iodir_stderr_file = -1;
+
+static int
+cute_iodir_create_file(const char * name)
+{
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+
+	int          fd;
+	const char * dir;
+
+	fd = memfd_create(name, MFD_CLOEXEC);
+	if (fd >= 0)
+		return fd;
+
+	dir = getenv("TMPDIR");
+	if (!dir || !dir[0])
+		dir = P_tmpdir;
+
+	fd = open(dir, O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (fd >= 0)
+		return fd;
+
+	return -errno;
+}
+
+static int
+cute_iodir_open_file(int * file, const char * name, FILE * stdio)
+{
+	cute_assert_intern(file);
+	cute_assert_intern(stdio);
+
+	int fd;
+	int ret;
+
+	fd = cute_iodir_create_file(name);
+	if (fd < 0)
+		return fd;
+
+	ret = fileno(stdio);
+	cute_assert_intern(ret >= 0);
+
+	fflush(stdio);
+
+	ret = cute_dup2(fd, ret);
+	if (ret < 0) {
+		close(fd);
+		return ret;
+	}
+
+	*file = fd;
+
+	return 0;
+}
+
+static void
+cute_iodir_close_file(int * file, FILE * stdio, int stdfd)
+{
+	cute_assert_intern(file);
+	cute_assert_intern(*file >= 0);
+	cute_assert_intern(stdio);
+	cute_assert_intern(stdfd >= 0);
+
+	int fd;
+	int err;
+
+	fd = fileno(stdio);
+	cute_assert_intern(fd >= 0);
+
+	do {
+		err = cute_dup2(fd, stdfd);
+	} while (err == -EINTR);
+
+	close(*file);
+	*file = -1;
+}
+
+/*
+ * Standard I/O file descriptor and capture file share the same open file
+ * description, hence the same file offset: content written since last rewind
+ * spans from start of file up to current end of file.
+ */
+static void
+cute_iodir_collect_file(int fd, struct cute_iodir_block * block)
+{
+	cute_assert_intern(fd >= 0);
+	cute_assert_intern(block);
+
+	off_t end;
+	off_t off = 0;
+	int   err __cute_unused;
+
+	end = lseek(fd, 0, SEEK_END);
+	cute_assert_intern(end >= 0);
+
+	while (off < end) {
+		struct cute_iodir_atom * atom;
+		size_t                   sz;
+		ssize_t                  ret;
+
+		atom = cute_iodir_block_atom(block);
+		sz = cute_iodir_atom_free_size(atom);
+		if ((off_t)sz > (end - off))
+			sz = (size_t)(end - off);
+
+		ret = pread(fd, cute_iodir_atom_free_data(atom), sz, off);
+		if (ret > 0) {
+			cute_iodir_atom_push_data(atom, (size_t)ret);
+			off += ret;
+			continue;
+		}
+		else if (!ret)
+			break;
+		else if (errno == EINTR)
+			continue;
+
+		cute_assert_intern(errno != EBADF);
+		cute_assert_intern(errno != EFAULT);
+		cute_assert_intern(errno != EINVAL);
+		break;
+	}
+
+	err = ftruncate(fd, 0);
+	cute_assert_intern(!err);
+
+	end = lseek(fd, 0, SEEK_SET);
+	cute_assert_intern(!end);
+}
+
+static void
+cute_iodir_file_redirect(struct cute_iodir_block * stdout_block,
+                         struct cute_iodir_block * stderr_block)
+{
+	cute_assert_intern(stdout_block);
+	cute_assert_intern(stdout_block->head);
+	cute_assert_intern(stdout_block->tail);
+	cute_assert_intern(cute_iodir_stdout_file >= 0);
+	cute_assert_intern(cute_iodir_stdout);
+	cute_assert_intern(!cute_iodir_stdout_block);
+	cute_assert_intern(stderr_block);
+	cute_assert_intern(stderr_block->head);
+	cute_assert_intern(stderr_block->tail);
+	cute_assert_intern(cute_iodir_stderr_file >= 0);
+	cute_assert_intern(cute_iodir_stderr);
+	cute_assert_intern(!cute_iodir_stderr_block);
+
+	cute_iodir_stdout_block = stdout_block;
+	cute_iodir_stderr_block = stderr_block;
+}
+
+static void
+cute_iodir_file_restore(void)
+{
+	cute_assert_intern(cute_iodir_stdout_file >= 0);
+	cute_assert_intern(cute_iodir_stdout);
+	cute_assert_intern(cute_iodir_stdout_block);
+	cute_assert_intern(cute_iodir_stderr_file >= 0);
+	cute_assert_intern(cute_iodir_stderr);
+	cute_assert_intern(cute_iodir_stderr_block);
+
+	fflush(NULL);
+
+	cute_iodir_collect_file(cute_iodir_stdout_file,
+	                        cute_iodir_stdout_block);
+	cute_iodir_collect_file(cute_iodir_stderr_file,
+	                        cute_iodir_stderr_block);
+
+	cute_iodir_stdout_block = NULL;
+	cute_iodir_stderr_block = NULL;
+}
+
+static int
+cute_iodir_file_open(const char ** msg)
+{
+	cute_assert_intern(msg);
+
+	int err;
+
+	err = cute_iodir_open_file(&cute_iodir_stdout_file,
+	                           "cute-stdout",
+	                           stdout);
+	if (err) {
+		*msg = "cannot redirect stdout";
+		return err;
+	}
+
+	err = cute_iodir_open_file(&cute_iodir_stderr_file,
+	                           "cute-stderr",
+	                           stderr);
+	if (err) {
+		*msg = "cannot redirect stderr";
+		cute_iodir_close_file(&cute_iodir_stdout_file,
+		                      cute_iodir_stdout,
+		                      STDOUT_FILENO);
+		return err;
+	}
+
+	return 0;
+}
+
+/*
+ * Capture files are shared with the parent process: create new ones so that
+ * both processes do not collect content of each other.
+ */
+static int
+cute_iodir_file_respawn(const char ** msg)
+{
+	cute_assert_intern(msg);
+
+	close(cute_iodir_stdout_file);
+	close(cute_iodir_stderr_file);
+
+	return cute_iodir_file_open(msg);
+}
+
+static void
+cute_iodir_file_close(void)
+{
+	cute_iodir_close_file(&cute_iodir_stderr_file,
+	                      cute_iodir_stderr,
+	                      STDERR_FILENO);
+	cute_iodir_close_file(&cute_iodir_stdout_file,
+	                      cute_iodir_stdout,
+	                      STDOUT_FILENO);
+}
+
+static const struct cute_iodir_ops cute_iodir_file_ops = {
+	.redirect = cute_iodir_file_redirect,
+	.restore  = cute_iodir_file_restore,
+	.respawn  = cute_iodir_file_respawn,
+	.close    = cute_iodir_file_close
+};
+
+/******************************************************************************
+ * Standard I/Os capture front-end
+ ******************************************************************************/
+
+static const struct cute_iodir_ops * cute_iodir_backend;
+
+void
+cute_iodir_redirect(struct cute_iodir_block * stdout_block,
+                    struct cute_iodir_block * stderr_block)
+{
+	cute_assert_intern(cute_iodir_backend);
+
+	cute_iodir_backend->redirect(stdout_block, stderr_block);
+}
+
+void
+cute_iodir_restore(void)
+{
+	cute_assert_intern(cute_iodir_backend);
+
+	cute_iodir_backend->restore();
+}
+
+int
+cute_iodir_init(void)
+{
+	const char * msg;
+	int          err;
+
+	cute_iodir_stdout = cute_iodir_dup_stdio(stdout);
+	if (!cute_iodir_stdout) {
+		err = -errno;
+		msg = "cannot duplicate stdout";
+		goto err;
+	}
+
+	cute_iodir_stderr = cute_iodir_dup_stdio(stderr);
+	if (!cute_iodir_stderr) {
+		err = -errno;
+		msg = "cannot duplicate stderr";
+		goto close_stdout;
+	}
+
+	cute_iodir_stdout_block = NULL;
+	cute_iodir_stderr_block = NULL;
+
+	return 0;
+
+close_stdout:
+	fclose(cute_iodir_stdout);
+err:
+	cute_error("cannot setup standard I/Os: %s: %s (%d)\n",
+	           msg,
+	           strerror(-err),
+	           -err);
+
+	return err;
+}
+
+/*
+ * Open capture backend the first time tests are about to run so that commands
+ * not running any test do not pay for it.
+ *
+ * File based capture is preferred. Fall back to pipe based capture when
+ * running onto kernels / filesystems that support neither memfd_create(2) nor
+ * O_TMPFILE.
+ */
+int
+cute_iodir_setup(void)
+{
+	cute_assert_intern(cute_iodir_stdout);
+	cute_assert_intern(cute_iodir_stderr);
+
+	const char *    msg;
+	struct timespec tspec;
+	int             err;
+
+	if (cute_iodir_backend)
+		return 0;
+
+	cute_prof_start(&tspec);
+
+	err = cute_iodir_file_open(&msg);
+	if (!err) {
+		cute_iodir_backend = &cute_iodir_file_ops;
+		goto out;
+	}
+
+	err = cute_iodir_pipe_open(&msg);
+	if (!err) {
+		cute_iodir_backend = &cute_iodir_pipe_ops;
+		goto out;
+	}
+
+	cute_error("cannot setup standard I/Os capture: %s: %s (%d)\n",
+	           msg,
+	           strerror(-err),
+	           -err);
+
+	return err;
+
+out:
+	cute_prof_stage("iodir", &tspec);
+
+	return 0;
+}
+
+/*
+ * Give a freshly fork(2)'ed child process its own standard I/Os capture
+ * context.
+ *
+ * Original standard I/Os duplicates, i.e. cute_iodir_stdout and
+ * cute_iodir_stderr, are kept as-is.
+ * The child process is expected to exit on failure, hence no cleanup.
+ */
+int
+cute_iodir_respawn(void)
+{
+	cute_assert_intern(cute_iodir_backend);
+	cute_assert_intern(cute_iodir_stdout);
+	cute_assert_intern(cute_iodir_stderr);
+
+	const char * msg;
+	int          err;
+
+	cute_iodir_stdout_block = NULL;
+	cute_iodir_stderr_block = NULL;
+
+	/* Lock may have been held by another thread of the parent at fork time. */
+	err = pthread_mutex_init(&cute_iodir_free_lck, NULL);
+	cute_assert_intern(!err);
+
+	err = cute_iodir_backend->respawn(&msg);
+	if (err) {
+		cute_error("cannot respawn standard I/Os: %s: %s (%d)\n",
+		           msg,
+		           strerror(-err),
+		           -err);
+		return err;
+	}
+
+	return 0;
+}
+
+void
+cute_iodir_fini(void)
+{
+	cute_assert_intern(cute_iodir_stdout);
+	cute_assert_intern(!cute_iodir_stdout_block);
+	cute_assert_intern(cute_iodir_stderr);
+	cute_assert_intern(!cute_iodir_stderr_block);
+
+	if (cute_iodir_backend) {
+		cute_iodir_backend->close();
+		cute_iodir_backend = NULL;
+	}
 
 	fclose(cute_iodir_stdout);
 	fclose(cute_iodir_stderr);
+
+	cute_iodir_drain_free_atoms();
 }
@@ -44,6 +44,17 @@ cute_iodir_print_block(FILE *                          stdio,
                        const struct cute_iodir_block * block,
                        cute_iodir_format_fn *          format);
 
+extern size_t
+cute_iodir_block_size(const struct cute_iodir_block * block);
+
+extern void
+cute_iodir_copy_block(const struct cute_iodir_block * block, char * data);
+
+extern void
+cute_iodir_fill_block(struct cute_iodir_block * block,
+                      const char *              data,
+                      size_t                    size);
+
 extern void
 cute_iodir_init_block(struct cute_iodir_block * block);
 
@@ -57,9 +68,15 @@ cute_iodir_redirect(struct cute_iodir_block * stdout_block,
 extern void
 cute_iodir_restore(void);
 
+extern int
+cute_iodir_respawn(void);
+
 extern int
 cute_iodir_init(void);
 
+extern int
+cute_iodir_setup(void);
+
 extern void
 cute_iodir_fini(void);
 
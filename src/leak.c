@@ -0,0 +1,355 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * File descriptor and thread leak detection.
+ *
+ * Open file descriptors and running threads are listed from /proc/self/fd and
+ * /proc/self/task right before a test setup fixture runs and right after its
+ * teardown fixture completes. Descriptors and threads found by the second
+ * listing only are leaks.
+ *
+ * Descriptors CUTe opens for its own purpose, i.e. standard I/O capture
+ * files or pipes, capture notification eventfd and report streams, are opened
+ * before tests are run and are therefore never considered. Performance counter
+ * descriptors are closed before the teardown fixture runs.
+ *
+ * Descriptors are identified by their device and inode numbers so that a
+ * descriptor closed then re-opened with the same number by a test is spotted.
+ *
+ * Tests of threaded suites run concurrently within the same process share
+ * descriptors and threads: they are not checked.
+ */
+
+#include "leak.h"
+#include "run.h"
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+struct cute_leak_fd {
+	int   fd;
+	dev_t dev;
+	ino_t ino;
+};
+
+struct cute_leak_snap {
+	struct cute_leak_fd * fds;
+	unsigned int          fds_nr;
+	int *                 tids;
+	unsigned int          tids_nr;
+};
+
+/* Maximum length of leaked resources description. */
+#define CUTE_LEAK_DESC_MAX (512U)
+
+/* Maximum number of leaked descriptors listed into description. */
+#define CUTE_LEAK_FD_MAX   (8U)
+
+static bool                  cute_leak_started;
+static struct cute_leak_snap cute_leak_before;
+
+static int
+cute_leak_cmp_id(const void * first, const void * second)
+{
+	int fst = *(const int *)first;
+	int snd = *(const int *)second;
+
+	return (fst > snd) - (fst < snd);
+}
+
+/*
+ * Load numeric entries of the given /proc directory, the descriptor used to
+ * list it excepted, as a sorted array of identifiers.
+ */
+static int
+cute_leak_load_ids(const char * path, int ** ids, unsigned int * nr)
+{
+	cute_assert_intern(path);
+	cute_assert_intern(ids);
+	cute_assert_intern(nr);
+
+	DIR *           dir;
+	int             self;
+	unsigned int    max = 0;
+	struct dirent * ent;
+
+	dir = opendir(path);
+	if (!dir)
+		return -errno;
+
+	self = dirfd(dir);
+	*ids = NULL;
+	*nr = 0;
+
+	while (true) {
+		long   id;
+		char * end;
+
+		errno = 0;
+		ent = readdir(dir);
+		if (!ent)
+			break;
+
+		id = strtol(ent->d_name, &end, 10);
+		if ((ent->d_name[0] < '0') || (ent->d_name[0] > '9') || *end ||
+		    (id > INT_MAX) || (id == self))
+			continue;
+
+		if (*nr == max) {
+			max = max ? (2 * max) : 64;
+			*ids = cute_realloc(*ids, max * sizeof((*ids)[0]));
+		}
+
+		(*ids)[(*nr)++] = (int)id;
+	}
+
+	if (errno) {
+		int err = -errno;
+
+		closedir(dir);
+		cute_free(*ids);
+
+		return err;
+	}
+
+	closedir(dir);
+
+	if (*nr)
+		qsort(*ids, *nr, sizeof((*ids)[0]), cute_leak_cmp_id);
+
+	return 0;
+}
+
+static int
+cute_leak_load_fds(struct cute_leak_snap * snap)
+{
+	cute_assert_intern(snap);
+
+	int *        ids;
+	unsigned int nr;
+	unsigned int i;
+	int          err;
+
+	err = cute_leak_load_ids("/proc/self/fd", &ids, &nr);
+	if (err)
+		return err;
+
+	snap->fds = nr ? cute_malloc(nr * sizeof(snap->fds[0])) : NULL;
+	snap->fds_nr = 0;
+
+	for (i = 0; i < nr; i++) {
+		struct stat           st;
+		struct cute_leak_fd * fd = &snap->fds[snap->fds_nr];
+
+		/* Descriptor closed in between: skip it. */
+		if (fstat(ids[i], &st))
+			continue;
+
+		fd->fd = ids[i];
+		fd->dev = st.st_dev;
+		fd->ino = st.st_ino;
+		snap->fds_nr++;
+	}
+
+	cute_free(ids);
+
+	return 0;
+}
+
+static int
+cute_leak_load(struct cute_leak_snap * snap)
+{
+	cute_assert_intern(snap);
+
+	int err;
+
+	err = cute_leak_load_fds(snap);
+	if (err)
+		return err;
+
+	err = cute_leak_load_ids("/proc/self/task", &snap->tids, &snap->tids_nr);
+	if (err) {
+		cute_free(snap->fds);
+		return err;
+	}
+
+	return 0;
+}
+
+static void
+cute_leak_unload(struct cute_leak_snap * snap)
+{
+	cute_assert_intern(snap);
+
+	cute_free(snap->tids);
+	cute_free(snap->fds);
+}
+
+static bool
+cute_leak_probe_fd(const struct cute_leak_snap * snap,
+                   const struct cute_leak_fd *   fd)
+{
+	cute_assert_intern(snap);
+	cute_assert_intern(fd);
+
+	const struct cute_leak_fd * prev;
+
+	/* fds is sorted by descriptor number since fd is its first field. */
+	prev = bsearch(&fd->fd,
+	               snap->fds,
+	               snap->fds_nr,
+	               sizeof(snap->fds[0]),
+	               cute_leak_cmp_id);
+
+	return prev && (prev->dev == fd->dev) && (prev->ino == fd->ino);
+}
+
+static bool
+cute_leak_probe_tid(const struct cute_leak_snap * snap, int tid)
+{
+	cute_assert_intern(snap);
+
+	return !!bsearch(&tid,
+	                 snap->tids,
+	                 snap->tids_nr,
+	                 sizeof(snap->tids[0]),
+	                 cute_leak_cmp_id);
+}
+
+static size_t
+cute_leak_describe_fd(char * desc, size_t len, int fd, unsigned int nr)
+{
+	cute_assert_intern(desc);
+	cute_assert_intern(len < CUTE_LEAK_DESC_MAX);
+
+	char    path[32];
+	char    target[128];
+	ssize_t ret;
+	int     cnt;
+
+	sprintf(path, "/proc/self/fd/%d", fd);
+	ret = readlink(path, target, sizeof(target) - 1);
+	if (ret < 0)
+		ret = 0;
+	target[ret] = '\0';
+
+	cnt = snprintf(&desc[len],
+	               CUTE_LEAK_DESC_MAX - len,
+	               "%s%d -> %s",
+	               nr ? ", " : "descriptors left open: ",
+	               fd,
+	               ret ? target : "?");
+	if (cnt < 0)
+		return len;
+
+	return (len + (size_t)cnt < CUTE_LEAK_DESC_MAX) ?
+	       len + (size_t)cnt : CUTE_LEAK_DESC_MAX - 1;
+}
+
+/*
+ * Compare current descriptors and threads against those listed before setup
+ * and return a description of resources left behind, or NULL when none were.
+ */
+static const char *
+cute_leak_describe(const struct cute_leak_snap * after)
+{
+	cute_assert_intern(after);
+
+	char         desc[CUTE_LEAK_DESC_MAX];
+	size_t       len = 0;
+	unsigned int fds = 0;
+	unsigned int tids = 0;
+	unsigned int i;
+	char *       str;
+
+	for (i = 0; i < after->fds_nr; i++) {
+		if (cute_leak_probe_fd(&cute_leak_before, &after->fds[i]))
+			continue;
+
+		if (fds < CUTE_LEAK_FD_MAX)
+			len = cute_leak_describe_fd(desc,
+			                            len,
+			                            after->fds[i].fd,
+			                            fds);
+		fds++;
+	}
+
+	if (fds > CUTE_LEAK_FD_MAX) {
+		int cnt = snprintf(&desc[len],
+		                   CUTE_LEAK_DESC_MAX - len,
+		                   " and %u more",
+		                   fds - CUTE_LEAK_FD_MAX);
+		if ((cnt > 0) && (len + (size_t)cnt < CUTE_LEAK_DESC_MAX))
+			len += (size_t)cnt;
+	}
+
+	for (i = 0; i < after->tids_nr; i++)
+		if (!cute_leak_probe_tid(&cute_leak_before, after->tids[i]))
+			tids++;
+
+	if (tids)
+		snprintf(&desc[len],
+		         CUTE_LEAK_DESC_MAX - len,
+		         "%sthreads left running: %u",
+		         fds ? " ; " : "",
+		         tids);
+	else if (!fds)
+		return NULL;
+
+	str = cute_run_alloc(strlen(desc) + 1);
+	strcpy(str, desc);
+
+	return str;
+}
+
+void
+cute_leak_start(void)
+{
+	cute_config_assert_intern(cute_the_config);
+	cute_assert_intern(!cute_leak_started);
+
+	int err;
+
+	if (!cute_the_config->leaks || cute_run_is_shared())
+		return;
+
+	err = cute_leak_load(&cute_leak_before);
+	if (err) {
+		cute_error("cannot list process resources: %s.\n",
+		           strerror(-err));
+		return;
+	}
+
+	cute_leak_started = true;
+}
+
+const char *
+cute_leak_stop(void)
+{
+	struct cute_leak_snap after;
+	const char *          desc = NULL;
+	int                   err;
+
+	if (!cute_leak_started)
+		return NULL;
+
+	err = cute_leak_load(&after);
+	if (!err) {
+		desc = cute_leak_describe(&after);
+		cute_leak_unload(&after);
+	}
+	else
+		cute_error("cannot list process resources: %s.\n",
+		           strerror(-err));
+
+	cute_leak_unload(&cute_leak_before);
+	cute_leak_started = false;
+
+	return desc;
+}
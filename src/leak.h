@@ -0,0 +1,19 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_LEAK_H
+#define _CUTE_LEAK_H
+
+#include "common.h"
+
+extern void
+cute_leak_start(void);
+
+extern const char *
+cute_leak_stop(void);
+
+#endif /* _CUTE_LEAK_H */
@@ -0,0 +1,541 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Heap allocation tracking helper library, i.e. libcute-heap.so.
+ *
+ * Allocator entry points are interposed so that blocks allocated while a test
+ * setup fixture, test function or teardown fixture run are recorded into a
+ * process-wide hash table, each block tagged with the tracking state of the
+ * test that owns it. Blocks still recorded once teardown fixture has completed
+ * are leaks.
+ *
+ * Blocks are owned by the test which thread allocated them. When tests are
+ * run one at a time, blocks allocated by other threads, i.e. threads spawned
+ * by the test, are owned by the running test as well. Tests of threaded
+ * suites run concurrently share the process: allocations of threads they
+ * spawn are not attributed.
+ *
+ * Since the table is shared, releasing a block from any thread removes it from
+ * the table of its owner. Releasing blocks that were not recorded, i.e.
+ * allocated before tracking started, is ignored.
+ *
+ * Interposed entry points forward requests to the glibc allocator, the very
+ * same allocator CUTe internals use through cute_malloc() and friends so that
+ * CUTe's own allocations never show up into statistics.
+ *
+ * This is built as a separate library which test programs must be linked
+ * against or which must be preloaded for heap tracking to be available so
+ * that programs linked against libcute do not get their allocator interposed
+ * by default. It is not linked against libcute since it may get preloaded
+ * into any process the test program spawns: it must not depend upon any
+ * libcute symbol. libcute drives tracking through the cute_heap_helper
+ * operations table it references weakly.
+ *
+ * Tracking state is given the initial-exec TLS model so that accessing it from
+ * within the allocator never requires dynamic TLS allocation.
+ */
+
+#include "heap.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <pthread.h>
+
+struct cute_heap_track {
+	bool             started;
+	bool             active;
+	size_t           nr;
+	size_t           live;
+	struct cute_heap stats;
+};
+
+struct cute_heap_block {
+	uintptr_t                ptr;
+	size_t                   size;
+	struct cute_heap_track * owner;
+};
+
+#define CUTE_HEAP_MIN_BLOCKS (64U)
+
+static __thread struct cute_heap_track cute_heap_curr
+	__attribute__((tls_model("initial-exec")));
+
+/* Set while the current thread performs allocations not owned by tests. */
+static __thread unsigned int           cute_heap_mute
+	__attribute__((tls_model("initial-exec")));
+
+/*
+ * Tracking state of the test owning blocks allocated by threads that do not
+ * run a test, when tests are run one at a time.
+ */
+static struct cute_heap_track * cute_heap_proc;
+
+/* Table of blocks recorded for all tests being tracked. */
+static pthread_mutex_t          cute_heap_lck = PTHREAD_MUTEX_INITIALIZER;
+static struct cute_heap_block * cute_heap_blocks;
+static size_t                   cute_heap_mask;
+static size_t                   cute_heap_nr;
+
+extern void * __libc_malloc(size_t);
+extern void * __libc_calloc(size_t, size_t);
+extern void * __libc_realloc(void *, size_t);
+extern void * __libc_memalign(size_t, size_t);
+extern void * __libc_valloc(size_t);
+extern void * __libc_pvalloc(size_t);
+extern void   __libc_free(void *);
+
+static size_t
+cute_heap_hash(uintptr_t ptr, size_t mask)
+{
+	return (size_t)(((uint64_t)ptr * UINT64_C(0x9e3779b97f4a7c15)) >> 32) &
+	       mask;
+}
+
+static void
+cute_heap_insert(struct cute_heap_block *       blocks,
+                 size_t                         mask,
+                 const struct cute_heap_block * block)
+{
+	size_t b;
+
+	for (b = cute_heap_hash(block->ptr, mask);
+	     blocks[b].ptr;
+	     b = (b + 1) & mask)
+		;
+
+	blocks[b] = *block;
+}
+
+/*
+ * Rehash blocks into a table of max entries, dropping those owned by the given
+ * tracking state if any.
+ */
+static bool
+cute_heap_rehash(size_t max, const struct cute_heap_track * drop)
+{
+	struct cute_heap_block * blocks;
+	size_t                   nr = 0;
+	size_t                   b;
+
+	blocks = __libc_calloc(max, sizeof(blocks[0]));
+	if (!blocks)
+		return false;
+
+	for (b = 0; cute_heap_blocks && (b <= cute_heap_mask); b++) {
+		if (!cute_heap_blocks[b].ptr ||
+		    (cute_heap_blocks[b].owner == drop))
+			continue;
+
+		cute_heap_insert(blocks, max - 1, &cute_heap_blocks[b]);
+		nr++;
+	}
+
+	__libc_free(cute_heap_blocks);
+	cute_heap_blocks = blocks;
+	cute_heap_mask = max - 1;
+	__atomic_store_n(&cute_heap_nr, nr, __ATOMIC_RELAXED);
+
+	return true;
+}
+
+/* Grow table when more than 3/4 full so that probe sequences remain short. */
+static bool
+cute_heap_grow(void)
+{
+	size_t max = cute_heap_blocks ? (cute_heap_mask + 1) : 0;
+
+	if ((4 * (cute_heap_nr + 1)) <= (3 * max))
+		return true;
+
+	return cute_heap_rehash(max ? (2 * max) : CUTE_HEAP_MIN_BLOCKS, NULL);
+}
+
+/*
+ * Return tracking state owning blocks allocated by the current thread, if
+ * any.
+ */
+static struct cute_heap_track *
+cute_heap_owner(void)
+{
+	if (cute_heap_mute)
+		return NULL;
+
+	if (cute_heap_curr.started)
+		return cute_heap_curr.active ? &cute_heap_curr : NULL;
+
+	return __atomic_load_n(&cute_heap_proc, __ATOMIC_ACQUIRE);
+}
+
+/* Must be called with cute_heap_lck held. */
+static void
+cute_heap_record_locked(struct cute_heap_track * owner,
+                        void *                   ptr,
+                        size_t                   size)
+{
+	struct cute_heap_block blk = {
+		.ptr   = (uintptr_t)ptr,
+		.size  = size,
+		.owner = owner
+	};
+
+	/* Tracking stopped in between by owner thread. */
+	if (!owner->started)
+		return;
+
+	owner->stats.allocs++;
+	owner->stats.bytes += size;
+
+	/* Block cannot be recorded: ignore its release. */
+	if (!cute_heap_grow())
+		return;
+
+	cute_heap_insert(cute_heap_blocks, cute_heap_mask, &blk);
+	__atomic_store_n(&cute_heap_nr, cute_heap_nr + 1, __ATOMIC_RELAXED);
+
+	owner->nr++;
+	owner->live += size;
+	if (owner->live > owner->stats.peak)
+		owner->stats.peak = owner->live;
+}
+
+static void
+cute_heap_record(struct cute_heap_track * owner, void * ptr, size_t size)
+{
+	if (!ptr)
+		return;
+
+	pthread_mutex_lock(&cute_heap_lck);
+	cute_heap_record_locked(owner, ptr, size);
+	pthread_mutex_unlock(&cute_heap_lck);
+}
+
+/*
+ * Remove block from table, shifting back entries of the probe sequence that
+ * follows so that no tombstones are needed. Return owner of block or NULL when
+ * block was not recorded.
+ *
+ * Must be called with cute_heap_lck held.
+ */
+static struct cute_heap_track *
+cute_heap_forget_locked(const void * ptr)
+{
+	size_t                   mask = cute_heap_mask;
+	struct cute_heap_block * blocks = cute_heap_blocks;
+	struct cute_heap_track * owner;
+	size_t                   b;
+	size_t                   n;
+
+	if (!cute_heap_nr)
+		return NULL;
+
+	for (b = cute_heap_hash((uintptr_t)ptr, mask);
+	     blocks[b].ptr != (uintptr_t)ptr;
+	     b = (b + 1) & mask)
+		if (!blocks[b].ptr)
+			return NULL;
+
+	owner = blocks[b].owner;
+	owner->live -= blocks[b].size;
+	owner->nr--;
+	__atomic_store_n(&cute_heap_nr, cute_heap_nr - 1, __ATOMIC_RELAXED);
+
+	for (n = (b + 1) & mask; blocks[n].ptr; n = (n + 1) & mask) {
+		size_t h = cute_heap_hash(blocks[n].ptr, mask);
+
+		/* Skip entries which home slot lies within (b, n]. */
+		if ((b < n) ? ((h > b) && (h <= n)) : ((h > b) || (h <= n)))
+			continue;
+
+		blocks[b] = blocks[n];
+		b = n;
+	}
+
+	blocks[b].ptr = 0;
+
+	return owner;
+}
+
+/*
+ * Remove blocks owned by the given tracking state. Must be called with
+ * cute_heap_lck held.
+ */
+static void
+cute_heap_drop_locked(struct cute_heap_track * owner)
+{
+	size_t b;
+
+	if (cute_heap_rehash(cute_heap_mask + 1, owner))
+		return;
+
+	/*
+	 * Out of memory: remove blocks in place. Removal may shift a block
+	 * behind the scanning position: keep scanning round the table till
+	 * all blocks are removed.
+	 */
+	for (b = 0; owner->nr; b = (b + 1) & cute_heap_mask)
+		if (cute_heap_blocks[b].ptr &&
+		    (cute_heap_blocks[b].owner == owner))
+			cute_heap_forget_locked(
+				(const void *)cute_heap_blocks[b].ptr);
+}
+
+static void
+cute_heap_forget(const void * ptr)
+{
+	/* Nothing recorded: spare locking to threads not being tracked. */
+	if (!ptr || !__atomic_load_n(&cute_heap_nr, __ATOMIC_RELAXED))
+		return;
+
+	pthread_mutex_lock(&cute_heap_lck);
+	cute_heap_forget_locked(ptr);
+	pthread_mutex_unlock(&cute_heap_lck);
+}
+
+extern void * malloc(size_t size) __cute_export;
+
+void *
+malloc(size_t size)
+{
+	void *                   ptr = __libc_malloc(size);
+	struct cute_heap_track * owner = cute_heap_owner();
+
+	if (owner)
+		cute_heap_record(owner, ptr, size);
+
+	return ptr;
+}
+
+extern void * calloc(size_t nmemb, size_t size) __cute_export;
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	void *                   ptr = __libc_calloc(nmemb, size);
+	struct cute_heap_track * owner = cute_heap_owner();
+
+	/* Product cannot overflow since allocation succeeded. */
+	if (owner)
+		cute_heap_record(owner, ptr, nmemb * size);
+
+	return ptr;
+}
+
+extern void * realloc(void * ptr, size_t size) __cute_export;
+
+void *
+realloc(void * ptr, size_t size)
+{
+	void *                   blk = __libc_realloc(ptr, size);
+	struct cute_heap_track * owner;
+
+	if (!ptr) {
+		owner = cute_heap_owner();
+		if (owner)
+			cute_heap_record(owner, blk, size);
+		return blk;
+	}
+
+	if ((!blk && size) || !__atomic_load_n(&cute_heap_nr, __ATOMIC_RELAXED))
+		return blk;
+
+	/*
+	 * Original block has been either moved, resized or released: it remains
+	 * owned by the same test whatever the thread resizing it. Resizing a
+	 * block not recorded is ignored.
+	 */
+	pthread_mutex_lock(&cute_heap_lck);
+	owner = cute_heap_forget_locked(ptr);
+	if (owner && blk)
+		cute_heap_record_locked(owner, blk, size);
+	pthread_mutex_unlock(&cute_heap_lck);
+
+	return blk;
+}
+
+extern void * reallocarray(void * ptr, size_t nmemb, size_t size)
+	__cute_export;
+
+void *
+reallocarray(void * ptr, size_t nmemb, size_t size)
+{
+	size_t bytes;
+
+	if (__builtin_mul_overflow(nmemb, size, &bytes)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	return realloc(ptr, bytes);
+}
+
+extern int posix_memalign(void ** memptr, size_t align, size_t size)
+	__cute_export;
+
+int
+posix_memalign(void ** memptr, size_t align, size_t size)
+{
+	void *                   ptr;
+	struct cute_heap_track * owner;
+
+	if (!align ||
+	    (align % sizeof(void *)) ||
+	    (align & (align - 1)))
+		return EINVAL;
+
+	ptr = __libc_memalign(align, size);
+	if (!ptr)
+		return ENOMEM;
+
+	owner = cute_heap_owner();
+	if (owner)
+		cute_heap_record(owner, ptr, size);
+
+	*memptr = ptr;
+
+	return 0;
+}
+
+extern void * memalign(size_t align, size_t size) __cute_export;
+
+void *
+memalign(size_t align, size_t size)
+{
+	void *                   ptr = __libc_memalign(align, size);
+	struct cute_heap_track * owner = cute_heap_owner();
+
+	if (owner)
+		cute_heap_record(owner, ptr, size);
+
+	return ptr;
+}
+
+extern void * aligned_alloc(size_t align, size_t size) __cute_export;
+
+void *
+aligned_alloc(size_t align, size_t size)
+{
+	if (!align || (align & (align - 1))) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return memalign(align, size);
+}
+
+extern void * valloc(size_t size) __cute_export;
+
+void *
+valloc(size_t size)
+{
+	void *                   ptr = __libc_valloc(size);
+	struct cute_heap_track * owner = cute_heap_owner();
+
+	if (owner)
+		cute_heap_record(owner, ptr, size);
+
+	return ptr;
+}
+
+/* Size is recorded as requested, i.e. not rounded up to page size. */
+extern void * pvalloc(size_t size) __cute_export;
+
+void *
+pvalloc(size_t size)
+{
+	void *                   ptr = __libc_pvalloc(size);
+	struct cute_heap_track * owner = cute_heap_owner();
+
+	if (owner)
+		cute_heap_record(owner, ptr, size);
+
+	return ptr;
+}
+
+extern void free(void * ptr) __cute_export;
+
+void
+free(void * ptr)
+{
+	cute_heap_forget(ptr);
+
+	__libc_free(ptr);
+}
+
+static void
+cute_heap_helper_start(bool shared)
+{
+	pthread_mutex_lock(&cute_heap_lck);
+	cute_heap_curr.nr = 0;
+	cute_heap_curr.live = 0;
+	memset(&cute_heap_curr.stats, 0, sizeof(cute_heap_curr.stats));
+	cute_heap_curr.started = true;
+	pthread_mutex_unlock(&cute_heap_lck);
+
+	if (!shared)
+		__atomic_store_n(&cute_heap_proc,
+		                 &cute_heap_curr,
+		                 __ATOMIC_RELEASE);
+}
+
+static void
+cute_heap_helper_resume(void)
+{
+	cute_heap_curr.active = cute_heap_curr.started;
+}
+
+static void
+cute_heap_helper_suspend(void)
+{
+	cute_heap_curr.active = false;
+}
+
+static void
+cute_heap_helper_stop(struct cute_heap * heap)
+{
+	if (!cute_heap_curr.started) {
+		memset(heap, 0, sizeof(*heap));
+		return;
+	}
+
+	if (__atomic_load_n(&cute_heap_proc, __ATOMIC_RELAXED) ==
+	    &cute_heap_curr)
+		__atomic_store_n(&cute_heap_proc, NULL, __ATOMIC_RELEASE);
+
+	pthread_mutex_lock(&cute_heap_lck);
+
+	*heap = cute_heap_curr.stats;
+	heap->tracked = true;
+	heap->leaks = cute_heap_curr.nr;
+
+	/*
+	 * Drop leaked blocks so that releasing them later on is ignored. Table
+	 * is released when no other test owns blocks.
+	 */
+	if (cute_heap_curr.nr == cute_heap_nr) {
+		__libc_free(cute_heap_blocks);
+		cute_heap_blocks = NULL;
+		cute_heap_mask = 0;
+		__atomic_store_n(&cute_heap_nr, 0, __ATOMIC_RELAXED);
+	}
+	else if (cute_heap_curr.nr)
+		cute_heap_drop_locked(&cute_heap_curr);
+
+	cute_heap_curr.nr = 0;
+	cute_heap_curr.started = false;
+
+	pthread_mutex_unlock(&cute_heap_lck);
+}
+
+const struct cute_heap_ops cute_heap_helper __cute_export = {
+	.start   = cute_heap_helper_start,
+	.resume  = cute_heap_helper_resume,
+	.suspend = cute_heap_helper_suspend,
+	.stop    = cute_heap_helper_stop,
+	.ignore  = cute_heap_forget
+};
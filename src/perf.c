@@ -0,0 +1,243 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Per test performance counters.
+ *
+ * Counters selected by cute_config::perfs are gathered into a
+ * perf_event_open(2) group opened for the thread running each test. Group is
+ * enabled right before the test function is called and disabled right after
+ * it returns. Only user space activity is counted so that unprivileged
+ * processes may sample hardware counters under the default
+ * perf_event_paranoid setting.
+ *
+ * Hardware counters are often not available when running within containers or
+ * virtual machines. Counters are therefore probed once before running tests:
+ * when none of the requested hardware counters may be opened, software
+ * counters are sampled instead.
+ */
+
+#include "perf.h"
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+struct cute_perf_event {
+	const char * name;
+	uint32_t     type;
+	uint64_t     config;
+};
+
+static const struct cute_perf_event cute_perf_events[CUTE_PERF_NR] = {
+	{ "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ "cache-misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	{ "task-clock",    PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+	{ "page-faults",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS }
+};
+
+#define CUTE_PERF_HW_MASK \
+	(CUTE_CONFIG_INSTR_PERF | \
+	 CUTE_CONFIG_CYCLE_PERF | \
+	 CUTE_CONFIG_CACHE_MISS_PERF | \
+	 CUTE_CONFIG_BRANCH_MISS_PERF)
+
+#define CUTE_PERF_SW_MASK \
+	(CUTE_CONFIG_TASK_CLOCK_PERF | \
+	 CUTE_CONFIG_PAGE_FAULT_PERF)
+
+/* Counters sampled for each test once probed. */
+static unsigned int  cute_perf_mask;
+
+/* Group of the test currently run by this thread. */
+static __thread int  cute_perf_lead = -1;
+static __thread int  cute_perf_fds[CUTE_PERF_NR] = { -1, -1, -1, -1, -1, -1 };
+
+const char *
+cute_perf_name(unsigned int counter)
+{
+	cute_assert_intern(counter < CUTE_PERF_NR);
+
+	return cute_perf_events[counter].name;
+}
+
+static int
+cute_perf_open_event(unsigned int counter, int group)
+{
+	cute_assert_intern(counter < CUTE_PERF_NR);
+
+	struct perf_event_attr attr;
+	long                   fd;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = cute_perf_events[counter].type;
+	attr.config = cute_perf_events[counter].config;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+	                   PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	if (group < 0)
+		/* Leader is enabled explicitly, members follow it. */
+		attr.disabled = 1;
+
+	fd = syscall(SYS_perf_event_open,
+	             &attr,
+	             0,
+	             -1,
+	             group,
+	             PERF_FLAG_FD_CLOEXEC);
+	if (fd < 0)
+		return -errno;
+
+	return (int)fd;
+}
+
+void
+cute_perf_open(void)
+{
+	unsigned int c;
+
+	cute_assert_intern(cute_perf_lead < 0);
+
+	if (!cute_perf_mask)
+		return;
+
+	for (c = 0; c < CUTE_PERF_NR; c++) {
+		int fd;
+
+		if (!(cute_perf_mask & (1U << c)))
+			continue;
+
+		/* Counters that cannot be opened are just left unsampled. */
+		fd = cute_perf_open_event(c, cute_perf_lead);
+		if (fd < 0)
+			continue;
+
+		cute_perf_fds[c] = fd;
+		if (cute_perf_lead < 0)
+			cute_perf_lead = fd;
+	}
+}
+
+void
+cute_perf_start(void)
+{
+	if (cute_perf_lead < 0)
+		return;
+
+	ioctl(cute_perf_lead, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/*
+ * Counters may have been multiplexed with other events, i.e. not counting for
+ * the whole time they were enabled: scale counts accordingly.
+ */
+static bool
+cute_perf_read(int fd, uint64_t * count)
+{
+	uint64_t vals[3];
+
+	if (read(fd, vals, sizeof(vals)) != (ssize_t)sizeof(vals))
+		return false;
+
+	if (vals[2] && (vals[2] < vals[1]))
+		*count = (uint64_t)((long double)vals[0] *
+		                    (long double)vals[1] /
+		                    (long double)vals[2]);
+	else
+		*count = vals[0];
+
+	return true;
+}
+
+void
+cute_perf_stop(struct cute_perf * perf)
+{
+	cute_assert_intern(perf);
+
+	unsigned int c;
+
+	perf->mask = 0;
+
+	if (cute_perf_lead < 0)
+		return;
+
+	ioctl(cute_perf_lead, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	for (c = 0; c < CUTE_PERF_NR; c++) {
+		if (cute_perf_fds[c] < 0)
+			continue;
+
+		if (cute_perf_read(cute_perf_fds[c], &perf->counts[c]))
+			perf->mask |= (1U << c);
+
+		close(cute_perf_fds[c]);
+		cute_perf_fds[c] = -1;
+	}
+
+	cute_perf_lead = -1;
+}
+
+static unsigned int
+cute_perf_probe(unsigned int mask, int * err)
+{
+	cute_assert_intern(err);
+
+	unsigned int c;
+	unsigned int avail = 0;
+
+	for (c = 0; c < CUTE_PERF_NR; c++) {
+		int fd;
+
+		if (!(mask & (1U << c)))
+			continue;
+
+		fd = cute_perf_open_event(c, -1);
+		if (fd < 0) {
+			*err = fd;
+			continue;
+		}
+
+		close(fd);
+		avail |= (1U << c);
+	}
+
+	return avail;
+}
+
+void
+cute_perf_init(void)
+{
+	cute_config_assert_intern(cute_the_config);
+
+	unsigned int req = cute_the_config->perfs;
+	int          err = 0;
+
+	cute_perf_mask = 0;
+	if (!req)
+		return;
+
+	cute_perf_mask = cute_perf_probe(req, &err);
+
+	if ((req & CUTE_PERF_HW_MASK) && !(cute_perf_mask & CUTE_PERF_HW_MASK)) {
+		cute_perf_mask |= cute_perf_probe(CUTE_PERF_SW_MASK &
+		                                  ~cute_perf_mask,
+		                                  &err);
+		if (cute_perf_mask)
+			cute_error("hardware performance counters not "
+			           "available: %s: "
+			           "sampling software counters instead.\n",
+			           strerror(-err));
+	}
+
+	if (!cute_perf_mask)
+		cute_error("cannot open performance counters: %s.\n",
+		           strerror(-err));
+}
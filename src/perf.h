@@ -0,0 +1,41 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_PERF_H
+#define _CUTE_PERF_H
+
+#include "common.h"
+#include <stdint.h>
+
+/* Performance counters, in cute_config_perf bit order. */
+#define CUTE_PERF_NR (6U)
+
+/*
+ * Performance counts of a test function run. Only counters which bit is set
+ * into mask hold a valid count.
+ */
+struct cute_perf {
+	unsigned int mask;
+	uint64_t     counts[CUTE_PERF_NR];
+};
+
+extern const char *
+cute_perf_name(unsigned int counter);
+
+extern void
+cute_perf_open(void);
+
+extern void
+cute_perf_start(void);
+
+extern void
+cute_perf_stop(struct cute_perf * perf);
+
+extern void
+cute_perf_init(void);
+
+#endif /* _CUTE_PERF_H */
@@ -0,0 +1,1249 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+/*
+ * Parallel run worker pool.
+ *
+ * Enabled test runs are collected in pre-order, i.e. in the order a sequential
+ * run would complete them, then handed out to a set of fork(2)'ed worker
+ * processes. A worker runs each test it is given as usual but with reporting
+ * diverted, then sends back the outcome: issue, timings, failure reason,
+ * rendered assessment and captured standard I/Os.
+ *
+ * Alternatively, tests of a threaded suite may be handed out to a set of
+ * threads running within the current process. These run tests the same way
+ * but directly record outcome into the related run since they share the
+ * parent address space. Fault handlers and standard I/Os redirection are
+ * process-wide: they are settled once for the whole suite, the latter on
+ * behalf of the suite run itself.
+ *
+ * Finally, tests inheriting the setup fixture of a suite may be run from a
+ * snapshot of the state this fixture produces. A single worker process runs
+ * the fixture once, then fork(2)s one child per test it is given so that each
+ * test starts from an identical copy-on-write post-setup state. Should the
+ * fixture fail, the worker falls back to running tests as usual so that
+ * failures get reported the same way as for a sequential run.
+ *
+ * Jobs are normally handed out in collection order. When a history of previous
+ * run results is available, they are handed out longest first instead
+ * (Longest Processing Time first scheduling) so that the whole run does not
+ * end up waiting for a long test started last.
+ *
+ * The parent process walks the run tree as it would for a sequential run. When
+ * reaching a test run, it waits for the related result then replays recorded
+ * events so that reporters are given the exact same sequence of events they
+ * would see when running sequentially.
+ */
+
+#include "pool.h"
+#include "hist.h"
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+enum cute_pool_field {
+	CUTE_POOL_WHAT_FIELD,
+	CUTE_POOL_WHY_FIELD,
+	CUTE_POOL_FILE_FIELD,
+	CUTE_POOL_FUNC_FIELD,
+	CUTE_POOL_DESC_FIELD,
+	CUTE_POOL_OUT_FIELD,
+	CUTE_POOL_ERR_FIELD,
+	CUTE_POOL_FIELD_NR
+};
+
+/*
+ * Test run result message sent by workers.
+ *
+ * Fields content is stored contiguously into the data area, in the order
+ * given by cute_pool_field. A zero length field stands for a NULL field.
+ * Parent and workers being the very same executable image, there is no need
+ * for marshalling.
+ */
+struct cute_pool_msg {
+	size_t             size;
+	unsigned int       job;
+	unsigned int       events;
+	enum cute_issue    issue;
+	int                line;
+	struct timespec    stamp;
+	struct cute_times  times;
+	struct cute_usage  usage;
+	struct cute_perf   perf;
+	struct cute_heap   heap;
+	struct cute_repeat repeat;
+	size_t             lens[CUTE_POOL_FIELD_NR];
+	char               data[];
+};
+
+struct cute_pool_job {
+	struct cute_run *      run;
+	struct cute_pool_msg * msg;
+	unsigned long          cost;
+	unsigned int           events;
+	bool                   sched;
+	bool                   done;
+};
+
+/* Cost of jobs missing from history so that these are dispatched first. */
+#define CUTE_POOL_UNK_COST (ULONG_MAX)
+
+#define CUTE_POOL_IDLE_JOB (UINT_MAX)
+
+/*
+ * Exit status of snapshot worker when teardown fixture failed, distinct from
+ * EXIT_FAILURE other worker failures exit with.
+ */
+#define CUTE_POOL_TEARDOWN_EXIT (2)
+
+struct cute_pool_worker {
+	pid_t        pid;
+	int          sock;
+	unsigned int job;
+};
+
+static struct cute_pool_job *    cute_pool_jobs;
+static unsigned int *            cute_pool_order;
+static unsigned int              cute_pool_nr;
+static unsigned int              cute_pool_next;
+static unsigned int              cute_pool_curr;
+static struct cute_pool_worker * cute_pool_workers;
+static struct pollfd *           cute_pool_fds;
+static unsigned int              cute_pool_count;
+static unsigned int              cute_pool_live;
+static struct cute_run *         cute_pool_section;
+static struct cute_run *         cute_pool_snap;
+static pthread_t *               cute_pool_thrs;
+static pthread_mutex_t           cute_pool_lck;
+static pthread_cond_t            cute_pool_cond;
+
+/*
+ * Return true when jobs are left to schedule, i.e. unless all of them have
+ * already been or run has been cut short (see cute_config::fail_fast).
+ */
+static bool
+cute_pool_pending(void)
+{
+	return (cute_pool_next < cute_pool_nr) && !cute_run_cut();
+}
+
+int
+cute_pool_send(int sock, const void * data, size_t size)
+{
+	cute_assert_intern(sock >= 0);
+	cute_assert_intern(data);
+	cute_assert_intern(size);
+
+	do {
+		ssize_t sz;
+
+		sz = send(sock, data, size, MSG_NOSIGNAL);
+		if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+
+			cute_assert_intern(errno != EBADF);
+			cute_assert_intern(errno != EFAULT);
+			cute_assert_intern(errno != EINVAL);
+
+			return -errno;
+		}
+
+		data = &((const char *)data)[sz];
+		size -= (size_t)sz;
+	} while (size);
+
+	return 0;
+}
+
+int
+cute_pool_recv(int sock, void * data, size_t size)
+{
+	cute_assert_intern(sock >= 0);
+	cute_assert_intern(data);
+	cute_assert_intern(size);
+
+	do {
+		ssize_t sz;
+
+		sz = recv(sock, data, size, 0);
+		if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+
+			cute_assert_intern(errno != EBADF);
+			cute_assert_intern(errno != EFAULT);
+			cute_assert_intern(errno != EINVAL);
+
+			return -errno;
+		}
+		else if (!sz)
+			/* Peer has closed its end of the connection. */
+			return -EPIPE;
+
+		data = &((char *)data)[sz];
+		size -= (size_t)sz;
+	} while (size);
+
+	return 0;
+}
+
+static struct cute_pool_msg *
+cute_pool_fetch(int sock)
+{
+	cute_assert_intern(sock >= 0);
+
+	size_t                 size;
+	struct cute_pool_msg * msg;
+
+	if (cute_pool_recv(sock, &size, sizeof(size)))
+		return NULL;
+
+	cute_assert_intern(size >= sizeof(*msg));
+	msg = cute_malloc(size);
+	msg->size = size;
+	if (cute_pool_recv(sock,
+	                   &((char *)msg)[sizeof(size)],
+	                   size - sizeof(size))) {
+		cute_free(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+static void
+cute_pool_crash(struct cute_pool_job * job, int status)
+{
+	cute_assert_intern(job);
+	cute_assert_intern(!job->done);
+
+	struct cute_run * run = job->run;
+
+	cute_run_assert_intern(run);
+
+	run->issue = CUTE_EXCP_ISSUE;
+	run->what = "exec crashed";
+	run->why = "worker process died";
+	cute_gettime(&run->times.exec.end);
+
+	if (WIFSIGNALED(status) &&
+	    (WTERMSIG(status) != SIGKILL) &&
+	    (WTERMSIG(status) != SIGSTOP))
+		cute_assess_build_excp(&run->assess, WTERMSIG(status));
+	else
+		cute_assess_build_expr(&run->assess, NULL);
+	cute_assess_update_source(&run->assess,
+	                          run->base->file,
+	                          run->base->line,
+	                          NULL);
+
+	job->events = (1U << CUTE_SETUP_EVT) | (1U << CUTE_DONE_EVT);
+	job->done = true;
+}
+
+/******************************************************************************
+ * Worker process side
+ ******************************************************************************/
+
+static struct cute_pool_msg *
+cute_pool_pack(unsigned int job, const struct cute_run * run, unsigned int events)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(run->state == CUTE_DONE_STATE);
+
+	const char *             strs[] = {
+		[CUTE_POOL_WHAT_FIELD] = run->what,
+		[CUTE_POOL_WHY_FIELD]  = run->why,
+		[CUTE_POOL_FILE_FIELD] = run->assess.file,
+		[CUTE_POOL_FUNC_FIELD] = run->assess.func
+	};
+	struct cute_text_block * blk = NULL;
+	size_t                   lens[CUTE_POOL_FIELD_NR];
+	size_t                   size = sizeof(struct cute_pool_msg);
+	struct cute_pool_msg *   msg;
+	char *                   data;
+	unsigned int             f;
+
+	for (f = 0; f < (sizeof(strs) / sizeof(strs[0])); f++)
+		lens[f] = strs[f] ? strlen(strs[f]) + 1 : 0;
+
+	/*
+	 * Assessment may refer to data living in this process only (mock
+	 * expectations, strings...): render its description here.
+	 */
+	lens[CUTE_POOL_DESC_FIELD] = 0;
+	if (run->what) {
+		blk = cute_assess_desc(&run->assess);
+		if (blk) {
+			unsigned int                  a;
+			const struct cute_text_atom * atom;
+
+			cute_text_foreach(blk, a, atom)
+				lens[CUTE_POOL_DESC_FIELD] +=
+					strlen(atom->str) + 1;
+		}
+	}
+
+	lens[CUTE_POOL_OUT_FIELD] = cute_iodir_block_size(&run->ioout);
+	lens[CUTE_POOL_ERR_FIELD] = cute_iodir_block_size(&run->ioerr);
+
+	for (f = 0; f < CUTE_POOL_FIELD_NR; f++)
+		size += lens[f];
+
+	msg = cute_malloc(size);
+	msg->size = size;
+	msg->job = job;
+	msg->events = events;
+	msg->issue = run->issue;
+	msg->line = run->assess.line;
+	msg->stamp = run->stamp;
+	msg->times = run->times;
+	msg->usage = run->usage;
+	msg->perf = run->perf;
+	msg->heap = run->heap;
+	msg->repeat = run->repeat;
+	memcpy(msg->lens, lens, sizeof(lens));
+
+	data = msg->data;
+	for (f = 0; f < (sizeof(strs) / sizeof(strs[0])); f++) {
+		memcpy(data, strs[f], lens[f]);
+		data += lens[f];
+	}
+
+	if (blk) {
+		unsigned int                  a;
+		const struct cute_text_atom * atom;
+
+		cute_text_foreach(blk, a, atom) {
+			size_t len = strlen(atom->str) + 1;
+
+			memcpy(data, atom->str, len);
+			data += len;
+		}
+
+		cute_text_destroy(blk);
+	}
+
+	cute_iodir_copy_block(&run->ioout, data);
+	data += lens[CUTE_POOL_OUT_FIELD];
+	cute_iodir_copy_block(&run->ioerr, data);
+
+	return msg;
+}
+
+static bool
+cute_pool_snap_fixture(struct cute_run * run, cute_test_fn * fixture)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(fixture);
+	cute_assert_intern(!cute_curr_run);
+
+	volatile bool ret = false;
+
+	cute_curr_run = run;
+	cute_run_settle(run);
+
+	if (!sigsetjmp(cute_jmp_env, 1)) {
+		fixture();
+		ret = true;
+	}
+
+	cute_run_unsettle(run);
+	cute_curr_run = NULL;
+
+	return ret;
+}
+
+static bool
+cute_pool_snap_setup(void)
+{
+	cute_run_assert_intern(cute_pool_snap);
+	cute_assert_intern(cute_pool_snap->state == CUTE_SETUP_STATE);
+	cute_assert_intern(cute_pool_snap->setup);
+
+	unsigned int j;
+
+	if (!cute_pool_snap_fixture(cute_pool_snap, cute_pool_snap->setup))
+		return false;
+
+	/* Fixture has been applied: prevent tests from running it again. */
+	for (j = 0; j < cute_pool_nr; j++)
+		cute_pool_jobs[j].run->setup = NULL;
+
+	return true;
+}
+
+static bool
+cute_pool_snap_teardown(void)
+{
+	cute_run_assert_intern(cute_pool_snap);
+
+	if (!cute_pool_snap->teardown)
+		return true;
+
+	cute_pool_snap->state = CUTE_TEARDOWN_STATE;
+
+	return cute_pool_snap_fixture(cute_pool_snap,
+	                              cute_pool_snap->teardown);
+}
+
+static struct cute_pool_msg *
+cute_pool_snap_run(unsigned int job, unsigned int * events)
+{
+	cute_assert_intern(job < cute_pool_nr);
+	cute_assert_intern(events);
+
+	struct cute_run *      run = cute_pool_jobs[job].run;
+	struct cute_pool_msg * msg;
+	int                    socks[2];
+	pid_t                  pid;
+	int                    status = 0;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, socks))
+		return NULL;
+
+	fflush(NULL);
+
+	pid = fork();
+	if (pid < 0) {
+		close(socks[0]);
+		close(socks[1]);
+		return NULL;
+	}
+
+	if (!pid) {
+		close(socks[0]);
+
+		if (cute_iodir_respawn() || cute_run_respawn_sigs())
+			_exit(EXIT_FAILURE);
+
+		*events = 0;
+		cute_run_oper(run, CUTE_COMPLETE_OPER);
+
+		msg = cute_pool_pack(job, run, *events);
+		if (cute_pool_send(socks[1], msg, msg->size))
+			_exit(EXIT_FAILURE);
+
+		_exit(EXIT_SUCCESS);
+	}
+
+	close(socks[1]);
+	msg = cute_pool_fetch(socks[0]);
+	close(socks[0]);
+
+	while ((waitpid(pid, &status, 0) < 0) && (errno == EINTR))
+		;
+
+	if (!msg) {
+		/* Test process died: report outcome on its behalf. */
+		cute_pool_crash(&cute_pool_jobs[job], status);
+		run->state = CUTE_DONE_STATE;
+		msg = cute_pool_pack(job, run, cute_pool_jobs[job].events);
+	}
+
+	return msg;
+}
+
+static void __cute_noreturn
+cute_pool_work(int sock)
+{
+	cute_assert_intern(sock >= 0);
+	cute_assert_intern(cute_pool_jobs);
+	cute_assert_intern(cute_pool_nr);
+
+	unsigned int events;
+	bool         snap = false;
+
+	if (cute_iodir_respawn() || cute_run_respawn_sigs())
+		_exit(EXIT_FAILURE);
+
+	cute_report_divert(&events);
+
+	if (cute_pool_snap)
+		snap = cute_pool_snap_setup();
+
+	while (true) {
+		unsigned int           job;
+		struct cute_pool_msg * msg;
+		int                    err;
+
+		if (cute_pool_recv(sock, &job, sizeof(job)))
+			/* Parent process is done with us. */
+			break;
+
+		cute_assert_intern(job < cute_pool_nr);
+
+		if (!snap) {
+			struct cute_run * run = cute_pool_jobs[job].run;
+
+			events = 0;
+			cute_run_oper(run, CUTE_COMPLETE_OPER);
+
+			msg = cute_pool_pack(job, run, events);
+		}
+		else {
+			msg = cute_pool_snap_run(job, &events);
+			if (!msg)
+				_exit(EXIT_FAILURE);
+		}
+
+		err = cute_pool_send(sock, msg, msg->size);
+		cute_free(msg);
+
+		if (err)
+			_exit(EXIT_FAILURE);
+	}
+
+	if (snap && !cute_pool_snap_teardown())
+		_exit(CUTE_POOL_TEARDOWN_EXIT);
+
+	_exit(EXIT_SUCCESS);
+}
+
+/******************************************************************************
+ * Parent process side
+ ******************************************************************************/
+
+static int
+cute_pool_spawn(struct cute_pool_worker * worker)
+{
+	cute_assert_intern(worker);
+	cute_assert_intern(worker->pid < 0);
+	cute_assert_intern(worker->sock < 0);
+
+	int   socks[2];
+	pid_t pid;
+	int   err;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, socks))
+		return -errno;
+
+	/* Prevent worker from flushing pending output a second time. */
+	fflush(NULL);
+
+	pid = fork();
+	if (pid < 0) {
+		err = -errno;
+		close(socks[0]);
+		close(socks[1]);
+		return err;
+	}
+
+	if (!pid) {
+		unsigned int w;
+
+		close(socks[0]);
+		for (w = 0; w < cute_pool_count; w++)
+			if (cute_pool_workers[w].sock >= 0)
+				close(cute_pool_workers[w].sock);
+
+		cute_pool_work(socks[1]);
+	}
+
+	close(socks[1]);
+
+	worker->pid = pid;
+	worker->sock = socks[0];
+	worker->job = CUTE_POOL_IDLE_JOB;
+	cute_pool_live++;
+
+	return 0;
+}
+
+static void
+cute_pool_dispatch(struct cute_pool_worker * worker)
+{
+	cute_assert_intern(worker);
+	cute_assert_intern(worker->pid > 0);
+	cute_assert_intern(worker->sock >= 0);
+	cute_assert_intern(worker->job == CUTE_POOL_IDLE_JOB);
+	cute_assert_intern(cute_pool_next <= cute_pool_nr);
+
+	unsigned int job;
+
+	if (!cute_pool_pending())
+		return;
+
+	job = cute_pool_order[cute_pool_next];
+
+	/*
+	 * On failure, worker is gone: it will be reaped at next poll(2) time
+	 * and job dispatched to another worker.
+	 */
+	if (cute_pool_send(worker->sock, &job, sizeof(job)))
+		return;
+
+	cute_getstamp(&cute_pool_jobs[job].run->stamp);
+	cute_gettime(&cute_pool_jobs[job].run->times.exec.begin);
+	cute_pool_jobs[job].sched = true;
+	worker->job = job;
+	cute_pool_next++;
+}
+
+static void
+cute_pool_load(struct cute_pool_job * job, struct cute_pool_msg * msg)
+{
+	cute_assert_intern(job);
+	cute_assert_intern(!job->done);
+	cute_assert_intern(!job->msg);
+	cute_assert_intern(msg);
+	cute_assert_intern(msg->events & (1U << CUTE_DONE_EVT));
+
+	struct cute_run * run = job->run;
+	const char *      fields[CUTE_POOL_FIELD_NR];
+	const char *      data = msg->data;
+	unsigned int      f;
+
+	cute_run_assert_intern(run);
+
+	for (f = 0; f < CUTE_POOL_FIELD_NR; f++) {
+		fields[f] = msg->lens[f] ? data : NULL;
+		data += msg->lens[f];
+	}
+
+	run->issue = msg->issue;
+	run->stamp = msg->stamp;
+	run->times = msg->times;
+	run->usage = msg->usage;
+	run->perf = msg->perf;
+	run->heap = msg->heap;
+	run->repeat = msg->repeat;
+	run->what = fields[CUTE_POOL_WHAT_FIELD];
+	run->why = fields[CUTE_POOL_WHY_FIELD];
+
+	if (fields[CUTE_POOL_DESC_FIELD])
+		cute_assess_build_text(&run->assess,
+		                       fields[CUTE_POOL_DESC_FIELD],
+		                       msg->lens[CUTE_POOL_DESC_FIELD]);
+	if (fields[CUTE_POOL_FILE_FIELD])
+		cute_assess_update_source(&run->assess,
+		                          fields[CUTE_POOL_FILE_FIELD],
+		                          msg->line,
+		                          fields[CUTE_POOL_FUNC_FIELD]);
+
+	if (fields[CUTE_POOL_OUT_FIELD])
+		cute_iodir_fill_block(&run->ioout,
+		                      fields[CUTE_POOL_OUT_FIELD],
+		                      msg->lens[CUTE_POOL_OUT_FIELD]);
+	if (fields[CUTE_POOL_ERR_FIELD])
+		cute_iodir_fill_block(&run->ioerr,
+		                      fields[CUTE_POOL_ERR_FIELD],
+		                      msg->lens[CUTE_POOL_ERR_FIELD]);
+
+	/* Message content is referenced by run: keep it till pool release. */
+	job->msg = msg;
+	job->events = msg->events;
+	job->done = true;
+
+	cute_run_tally(run);
+}
+
+static void
+cute_pool_reap(struct cute_pool_worker * worker)
+{
+	cute_assert_intern(worker);
+	cute_assert_intern(worker->pid > 0);
+	cute_assert_intern(worker->sock >= 0);
+	cute_assert_intern(cute_pool_live);
+
+	int status = 0;
+
+	close(worker->sock);
+	while ((waitpid(worker->pid, &status, 0) < 0) && (errno == EINTR))
+		;
+
+	if (worker->job != CUTE_POOL_IDLE_JOB) {
+		cute_pool_crash(&cute_pool_jobs[worker->job], status);
+		cute_run_tally(cute_pool_jobs[worker->job].run);
+	}
+
+	worker->pid = -1;
+	worker->sock = -1;
+	worker->job = CUTE_POOL_IDLE_JOB;
+	cute_pool_live--;
+
+	if (cute_pool_pending() && !cute_pool_spawn(worker))
+		cute_pool_dispatch(worker);
+}
+
+static void
+cute_pool_receive(struct cute_pool_worker * worker)
+{
+	cute_assert_intern(worker);
+	cute_assert_intern(worker->pid > 0);
+	cute_assert_intern(worker->sock >= 0);
+
+	struct cute_pool_msg * msg;
+
+	msg = cute_pool_fetch(worker->sock);
+	if (!msg) {
+		cute_pool_reap(worker);
+		return;
+	}
+
+	cute_assert_intern(msg->job == worker->job);
+	cute_pool_load(&cute_pool_jobs[msg->job], msg);
+
+	worker->job = CUTE_POOL_IDLE_JOB;
+	cute_pool_dispatch(worker);
+}
+
+static void
+cute_pool_wait(void)
+{
+	cute_assert_intern(cute_pool_live);
+
+	unsigned int w;
+	int          ret;
+
+	for (w = 0; w < cute_pool_count; w++) {
+		cute_pool_fds[w].fd = cute_pool_workers[w].sock;
+		cute_pool_fds[w].events = POLLIN;
+		cute_pool_fds[w].revents = 0;
+	}
+
+	do {
+		ret = poll(cute_pool_fds, cute_pool_count, -1);
+	} while ((ret < 0) && (errno == EINTR));
+	cute_assert(ret > 0);
+
+	for (w = 0; w < cute_pool_count; w++)
+		if (cute_pool_fds[w].revents)
+			cute_pool_receive(&cute_pool_workers[w]);
+}
+
+/******************************************************************************
+ * Worker thread side
+ ******************************************************************************/
+
+static void *
+cute_pool_run_thread(void * arg __cute_unused)
+{
+	unsigned int events;
+	int          err;
+
+	err = cute_run_init_thread_sigs();
+	if (err) {
+		cute_error("cannot setup worker thread: %s (%d).\n",
+		           strerror(-err),
+		           -err);
+		goto exit;
+	}
+
+	cute_report_divert(&events);
+
+	cute_lock(&cute_pool_lck);
+
+	while (cute_pool_pending()) {
+		struct cute_pool_job * job =
+			&cute_pool_jobs[cute_pool_order[cute_pool_next++]];
+
+		job->sched = true;
+		cute_unlock(&cute_pool_lck);
+
+		events = 0;
+		cute_run_oper(job->run, CUTE_COMPLETE_OPER);
+
+		cute_lock(&cute_pool_lck);
+
+		job->events = events;
+		job->done = true;
+		cute_cond_signal(&cute_pool_cond);
+	}
+
+	cute_unlock(&cute_pool_lck);
+
+	cute_run_fini_thread_sigs();
+
+exit:
+	cute_lock(&cute_pool_lck);
+	cute_pool_live--;
+	cute_cond_signal(&cute_pool_cond);
+	cute_unlock(&cute_pool_lck);
+
+	return NULL;
+}
+
+/*
+ * Wait for a worker thread to complete the given job.
+ *
+ * Return false when no more worker threads are left to run it, in which case
+ * it must be run in-process by the caller.
+ */
+static bool
+cute_pool_await(struct cute_pool_job * job)
+{
+	cute_assert_intern(job);
+	cute_assert_intern(cute_pool_section);
+
+	bool done;
+
+	cute_lock(&cute_pool_lck);
+
+	while (!job->done &&
+	       cute_pool_live &&
+	       (job->sched || !cute_run_cut()))
+		cute_cond_wait(&cute_pool_cond, &cute_pool_lck);
+
+	/*
+	 * Threads exit once all jobs have been picked up: an incomplete job
+	 * left with no more threads has never been started. Neither has an
+	 * unscheduled job once run has been cut short.
+	 */
+	done = job->done;
+
+	cute_unlock(&cute_pool_lck);
+
+	return done;
+}
+
+/******************************************************************************
+ * Run tree walker side
+ ******************************************************************************/
+
+void
+cute_pool_complete(struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+
+	struct cute_pool_job * job;
+
+	if (!cute_pool_jobs ||
+	    (cute_pool_curr == cute_pool_nr) ||
+	    (cute_pool_jobs[cute_pool_curr].run != run)) {
+		/* Disabled run or run not eligible to snapshot. */
+		cute_run_oper(run, CUTE_COMPLETE_OPER);
+		return;
+	}
+
+	job = &cute_pool_jobs[cute_pool_curr++];
+
+	if (cute_pool_section) {
+		if (!cute_pool_await(job)) {
+			cute_run_oper(run, CUTE_COMPLETE_OPER);
+			return;
+		}
+	}
+	else {
+		while (!job->done) {
+			if (!cute_pool_live ||
+			    (!job->sched && cute_run_cut())) {
+				/*
+				 * No more workers: all dispatched jobs have
+				 * been completed. Fallback to running
+				 * in-process. The same applies to jobs left
+				 * unscheduled once run has been cut short.
+				 */
+				cute_run_oper(run, CUTE_COMPLETE_OPER);
+				return;
+			}
+
+			cute_pool_wait();
+		}
+	}
+
+	cute_assert_intern(job->done);
+	cute_run_replay(job->run, job->events);
+}
+
+static bool
+cute_pool_eligible(const struct cute_run * run, enum cute_visit visit)
+{
+	cute_run_assert_intern(run);
+
+	if ((visit != CUTE_ONCE_VISIT) ||
+	    (run->state == CUTE_OFF_STATE) ||
+	    run->cached)
+		/* Cached runs complete instantly: keep these in-process. */
+		return false;
+
+	if (cute_pool_snap)
+		/*
+		 * Only direct children tests inheriting the fixture the
+		 * snapshot is taken from may be run out of it.
+		 */
+		return (run->parent == cute_pool_snap) &&
+		       (run->base->setup == CUTE_INHR_SETUP);
+
+	return true;
+}
+
+static void
+cute_pool_count_run(struct cute_run * run,
+                    enum cute_visit   visit,
+                    void *            data __cute_unused)
+{
+	cute_run_assert_intern(run);
+
+	if (cute_pool_eligible(run, visit))
+		cute_pool_nr++;
+}
+
+static void
+cute_pool_collect_run(struct cute_run * run,
+                      enum cute_visit   visit,
+                      void *            data)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(data);
+
+	unsigned int * cnt = (unsigned int *)data;
+
+	if (cute_pool_eligible(run, visit)) {
+		struct cute_pool_job * job = &cute_pool_jobs[(*cnt)++];
+
+		cute_assert_intern(*cnt <= cute_pool_nr);
+
+		job->run = run;
+		job->msg = NULL;
+		if (!cute_hist_probe_time(run->name, &job->cost))
+			job->cost = CUTE_POOL_UNK_COST;
+		job->events = 0;
+		job->sched = false;
+		job->done = false;
+	}
+}
+
+static int
+cute_pool_cmp_cost(const void * first, const void * second)
+{
+	unsigned int                 fst = *(const unsigned int *)first;
+	unsigned int                 snd = *(const unsigned int *)second;
+	const struct cute_pool_job * fjob = &cute_pool_jobs[fst];
+	const struct cute_pool_job * sjob = &cute_pool_jobs[snd];
+
+	if (fjob->cost != sjob->cost)
+		return (fjob->cost > sjob->cost) ? -1 : 1;
+
+	/* Preserve collection order between jobs of identical cost. */
+	return (fst > snd) - (fst < snd);
+}
+
+static bool
+cute_pool_collect(struct cute_run * root)
+{
+	cute_run_assert_intern(root);
+	cute_assert_intern(!cute_pool_jobs);
+
+	unsigned int cnt = 0;
+
+	cute_pool_nr = 0;
+	cute_run_foreach(root, cute_pool_count_run, NULL);
+	if (!cute_pool_nr)
+		return false;
+
+	cute_pool_jobs = cute_malloc(cute_pool_nr * sizeof(cute_pool_jobs[0]));
+	cute_run_foreach(root, cute_pool_collect_run, &cnt);
+	cute_assert_intern(cnt == cute_pool_nr);
+
+	cute_pool_order = cute_malloc(cute_pool_nr *
+	                              sizeof(cute_pool_order[0]));
+	for (cnt = 0; cnt < cute_pool_nr; cnt++)
+		cute_pool_order[cnt] = cnt;
+	if (cute_the_config->hist_path)
+		qsort(cute_pool_order,
+		      cute_pool_nr,
+		      sizeof(cute_pool_order[0]),
+		      cute_pool_cmp_cost);
+
+	cute_pool_next = 0;
+	cute_pool_curr = 0;
+	cute_pool_live = 0;
+
+	return true;
+}
+
+static void
+cute_pool_release(void)
+{
+	unsigned int j;
+
+	for (j = 0; j < cute_pool_nr; j++)
+		cute_free(cute_pool_jobs[j].msg);
+
+	cute_free(cute_pool_order);
+	cute_free(cute_pool_jobs);
+
+	cute_pool_order = NULL;
+	cute_pool_jobs = NULL;
+	cute_pool_nr = 0;
+	cute_pool_count = 0;
+	cute_pool_live = 0;
+}
+
+void
+cute_pool_enter(struct cute_run * run, unsigned int threads)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(run->state != CUTE_OFF_STATE);
+	cute_assert_intern(threads > 1);
+
+	sigset_t     set;
+	unsigned int t;
+	int          err;
+
+	if (cute_pool_jobs)
+		/*
+		 * Tests are already being dispatched, either to worker
+		 * processes or to the threads of an enclosing threaded suite.
+		 */
+		return;
+
+	if (!cute_pool_collect(run))
+		return;
+
+	err = cute_lock_init(&cute_pool_lck);
+	if (err)
+		goto release;
+
+	err = cute_cond_init(&cute_pool_cond);
+	if (err)
+		goto fini_lock;
+
+	cute_pool_section = run;
+	cute_pool_count = (threads < cute_pool_nr) ? threads : cute_pool_nr;
+	cute_pool_thrs = cute_malloc(cute_pool_count *
+	                             sizeof(cute_pool_thrs[0]));
+
+	cute_run_share(run);
+
+	/* Worker threads unblock the signals they are meant to handle. */
+	err = sigfillset(&set);
+	cute_assert_intern(!err);
+
+	cute_lock(&cute_pool_lck);
+
+	for (t = 0; t < cute_pool_count; t++) {
+		err = cute_thr_create(&cute_pool_thrs[t],
+		                      &set,
+		                      cute_pool_run_thread,
+		                      NULL);
+		if (err) {
+			cute_error("cannot spawn worker thread: %s (%d).\n",
+			           strerror(-err),
+			           -err);
+			break;
+		}
+
+		cute_pool_live++;
+	}
+
+	/* Remaining jobs are run in-process when no thread could be spawned. */
+	cute_pool_count = t;
+
+	cute_unlock(&cute_pool_lck);
+
+	return;
+
+fini_lock:
+	cute_lock_fini(&cute_pool_lck);
+release:
+	cute_error("cannot setup worker threads: %s (%d).\n",
+	           strerror(-err),
+	           -err);
+	cute_pool_release();
+}
+
+static void
+cute_pool_start(unsigned int count)
+{
+	cute_assert_intern(count);
+	cute_assert_intern(cute_pool_nr);
+
+	unsigned int w;
+
+	cute_pool_count = (count < cute_pool_nr) ? count : cute_pool_nr;
+	cute_pool_workers = cute_malloc(cute_pool_count *
+	                                sizeof(cute_pool_workers[0]));
+	cute_pool_fds = cute_malloc(cute_pool_count * sizeof(cute_pool_fds[0]));
+
+	for (w = 0; w < cute_pool_count; w++) {
+		cute_pool_workers[w].pid = -1;
+		cute_pool_workers[w].sock = -1;
+		cute_pool_workers[w].job = CUTE_POOL_IDLE_JOB;
+	}
+
+	for (w = 0; w < cute_pool_count; w++) {
+		int err;
+
+		err = cute_pool_spawn(&cute_pool_workers[w]);
+		if (err) {
+			cute_error("cannot spawn worker: %s (%d).\n",
+			           strerror(-err),
+			           -err);
+			break;
+		}
+	}
+
+	for (w = 0; w < cute_pool_count; w++)
+		if (cute_pool_workers[w].pid > 0)
+			cute_pool_dispatch(&cute_pool_workers[w]);
+}
+
+/*
+ * Stop worker processes and release pool.
+ *
+ * Return wait status of the last worker process that exited abnormally, 0 if
+ * all of them exited successfully.
+ */
+static int
+cute_pool_stop(void)
+{
+	unsigned int w;
+	int          ret = 0;
+
+	for (w = 0; w < cute_pool_count; w++) {
+		struct cute_pool_worker * worker = &cute_pool_workers[w];
+		int                       status = 0;
+
+		if (worker->pid < 0)
+			continue;
+
+		close(worker->sock);
+		while ((waitpid(worker->pid, &status, 0) < 0) &&
+		       (errno == EINTR))
+			;
+
+		if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+			ret = status;
+	}
+
+	cute_free(cute_pool_fds);
+	cute_free(cute_pool_workers);
+	cute_pool_fds = NULL;
+	cute_pool_workers = NULL;
+
+	cute_pool_release();
+
+	return ret;
+}
+
+void
+cute_pool_snapshot(struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(run->state == CUTE_SETUP_STATE);
+	cute_assert_intern(run->setup);
+
+	if (cute_pool_jobs)
+		/* Tests are already being dispatched. */
+		return;
+
+	cute_pool_snap = run;
+	if (!cute_pool_collect(run)) {
+		cute_pool_snap = NULL;
+		return;
+	}
+
+	cute_pool_start(1);
+}
+
+static void
+cute_pool_snap_leave(struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(run == cute_pool_snap);
+	cute_assert_intern(cute_pool_curr == cute_pool_nr);
+
+	int status;
+
+	status = cute_pool_stop();
+	if (!status)
+		goto out;
+
+	if (WIFEXITED(status) &&
+	    (WEXITSTATUS(status) == CUTE_POOL_TEARDOWN_EXIT)) {
+		run->issue = CUTE_FAIL_ISSUE;
+		run->what = "teardown failed";
+		run->why = "snapshot teardown failed";
+		cute_assess_build_expr(&run->assess, NULL);
+	}
+	else {
+		/*
+		 * Snapshot worker could not complete on its own, i.e. it was
+		 * killed or failed to fork(2) / communicate with test
+		 * processes.
+		 */
+		run->issue = CUTE_EXCP_ISSUE;
+		run->what = "exec crashed";
+		run->why = "snapshot worker process failed";
+		if (WIFSIGNALED(status) &&
+		    (WTERMSIG(status) != SIGKILL) &&
+		    (WTERMSIG(status) != SIGSTOP))
+			cute_assess_build_excp(&run->assess, WTERMSIG(status));
+		else
+			cute_assess_build_expr(&run->assess, NULL);
+	}
+
+	cute_assess_update_source(&run->assess,
+	                          run->base->file,
+	                          run->base->line,
+	                          NULL);
+
+out:
+	cute_pool_snap = NULL;
+}
+
+void
+cute_pool_leave(struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+
+	unsigned int t;
+
+	if (run == cute_pool_snap) {
+		cute_pool_snap_leave(run);
+		return;
+	}
+
+	if (run != cute_pool_section)
+		return;
+
+	cute_assert_intern(cute_pool_curr == cute_pool_nr);
+
+	for (t = 0; t < cute_pool_count; t++)
+		cute_thr_join(cute_pool_thrs[t], NULL);
+
+	cute_run_unshare(run);
+
+	cute_cond_fini(&cute_pool_cond);
+	cute_lock_fini(&cute_pool_lck);
+
+	cute_free(cute_pool_thrs);
+	cute_pool_thrs = NULL;
+	cute_pool_section = NULL;
+
+	cute_pool_release();
+}
+
+void
+cute_pool_init(struct cute_run * root, unsigned int jobs)
+{
+	cute_run_assert_intern(root);
+	cute_assert_intern(jobs > 1);
+	cute_assert_intern(!cute_pool_jobs);
+
+	if (!cute_pool_collect(root))
+		return;
+
+	cute_pool_start(jobs);
+}
+
+void
+cute_pool_fini(void)
+{
+	if (!cute_pool_jobs)
+		return;
+
+	cute_assert_intern(!cute_pool_section);
+	cute_assert_intern(!cute_pool_snap);
+
+	cute_pool_stop();
+}
@@ -0,0 +1,37 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#ifndef _CUTE_POOL_H
+#define _CUTE_POOL_H
+
+#include "run.h"
+
+extern int
+cute_pool_send(int sock, const void * data, size_t size);
+
+extern int
+cute_pool_recv(int sock, void * data, size_t size);
+
+extern void
+cute_pool_complete(struct cute_run * run);
+
+extern void
+cute_pool_enter(struct cute_run * run, unsigned int threads);
+
+extern void
+cute_pool_snapshot(struct cute_run * run);
+
+extern void
+cute_pool_leave(struct cute_run * run);
+
+extern void
+cute_pool_init(struct cute_run * root, unsigned int jobs);
+
+extern void
+cute_pool_fini(void);
+
+#endif /* _CUTE_POOL_H */
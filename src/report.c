@@ -92,6 +92,7 @@ cute_term_issue_color(const struct cute_term * term, enum cute_issue issue)
 		return term->red;
 
 	case CUTE_OFF_ISSUE:
+	case CUTE_CUT_ISSUE:
 		return term->gray;
 
 	default:
@@ -103,9 +104,10 @@ cute_term_issue_color(const struct cute_term * term, enum cute_issue issue)
  * Generic report handling
  ******************************************************************************/
 
-static unsigned int          cute_report_count;
-static struct cute_report ** cute_report_table;
-static unsigned int          cute_report_done;
+static unsigned int            cute_report_count;
+static struct cute_report **   cute_report_table;
+static unsigned int            cute_report_done;
+static __thread unsigned int * cute_report_diverted;
 
 void
 cute_report_printf_block(const struct cute_text_block * block,
@@ -148,6 +150,11 @@ cute_report_handle(enum cute_event         event,
 
 	unsigned int r;
 
+	if (cute_report_diverted) {
+		*cute_report_diverted |= 1U << event;
+		return;
+	}
+
 	if (event == CUTE_DONE_EVT)
 		cute_report_done++;
 
@@ -160,6 +167,25 @@ cute_report_handle(enum cute_event         event,
 		                             run);
 }
 
+/*
+ * When given a non-NULL events mask, record events into it instead of
+ * dispatching them to registered reporters.
+ * This is used by parallel run workers which leave reporting up to the parent
+ * process.
+ *
+ * Return the events mask previously in use so that callers may nest
+ * diversions.
+ */
+unsigned int *
+cute_report_divert(unsigned int * events)
+{
+	unsigned int * prev = cute_report_diverted;
+
+	cute_report_diverted = events;
+
+	return prev;
+}
+
 void
 cute_report_test(enum cute_event event, const struct cute_run * run)
 {
@@ -169,6 +169,9 @@ cute_report_printf_block(const struct cute_text_block * block,
 extern unsigned int
 cute_report_progress(void);
 
+extern unsigned int *
+cute_report_divert(unsigned int * events);
+
 extern void
 cute_report_test(enum cute_event event, const struct cute_run * run);
 
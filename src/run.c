@@ -10,8 +10,20 @@
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
 
-struct cute_run * volatile cute_curr_run;
+#if !defined(sigev_notify_thread_id)
+/* Not exposed by glibc versions prior to 2.41. */
+#define sigev_notify_thread_id _sigev_un._tid
+#endif /* !defined(sigev_notify_thread_id) */
+
+__thread struct cute_run * volatile cute_curr_run;
+
+/*
+ * Number of failed or crashed tests so far, updated by concurrent worker
+ * threads as well.
+ */
+unsigned int cute_run_fails;
 
 static const char *
 cute_run_what(const struct cute_run * run, enum cute_issue issue)
@@ -122,9 +134,16 @@ static struct sigaction       cute_run_timer_act;
 static sigset_t               cute_run_sigmask;
 static sigset_t               cute_run_blksig;
 
-static stack_t                cute_run_sigstack = {
-	.ss_flags = 0,
-};
+/*
+ * Set when fault / timeout handlers and standard I/O redirection are settled
+ * once for all runs of a section that executes concurrently.
+ */
+static bool                   cute_run_shared;
+
+/* Each running thread owns its signal stack and timeout timer. */
+static __thread stack_t       cute_run_sigstack;
+static __thread timer_t       cute_run_timer;
+static __thread timer_t       cute_run_cpu_timer;
 
 static void
 cute_run_handle_sig(int         sig,
@@ -144,16 +163,54 @@ cute_run_handle_sig(int         sig,
 	siglongjmp(cute_jmp_env, CUTE_EXCP_ISSUE);
 }
 
+enum cute_run_timer_kind {
+	CUTE_RUN_WALL_TIMER,
+	CUTE_RUN_CPU_TIMER
+};
+
+static void
+cute_run_handle_tmout(int         sig __cute_unused,
+                      siginfo_t * info,
+                      void *      context __cute_unused)
+{
+	cute_assert_intern(sig == SIGALRM);
+	cute_assert_intern(info);
+	cute_run_assert_intern(cute_curr_run);
+
+	if (cute_curr_run->issue != CUTE_UNK_ISSUE)
+		/*
+		 * Test case has completed but timer has not yet been disabled:
+		 * Ignore the timeout.
+		 */
+		return;
+
+	cute_assess_release(&cute_curr_run->assess);
+	cute_assess_build_expr(&cute_curr_run->assess, NULL);
+	cute_break(CUTE_FAIL_ISSUE,
+	           cute_curr_run->base->file,
+	           cute_curr_run->base->line,
+	           NULL,
+	           (info->si_value.sival_int == CUTE_RUN_CPU_TIMER) ?
+	           "CPU time exhausted" : "timer expired");
+
+	siglongjmp(cute_jmp_env, CUTE_FAIL_ISSUE);
+}
+
 static void
 cute_run_settle_sigs(void)
 {
 	if (!cute_the_config->debug) {
-		unsigned int s;
+		unsigned int           s;
+		int                    err __cute_unused;
+		const struct sigaction tmr = {
+			.sa_sigaction = cute_run_handle_tmout,
+			.sa_mask      = cute_run_sigmask,
+			.sa_flags     = SA_SIGINFO | SA_ONSTACK
+		};
 
 		for (s = 0;
 		     s < (sizeof(cute_run_sigs) / sizeof(cute_run_sigs[0]));
 		     s++) {
-			int                    err __cute_unused;
 			const struct sigaction act = {
 				.sa_sigaction = cute_run_handle_sig,
 				.sa_mask      = cute_run_sigmask,
@@ -165,6 +222,15 @@ cute_run_settle_sigs(void)
 			                &cute_run_sigs[s].old);
 			cute_assert_intern(!err);
 		}
+
+		/*
+		 * As stated into section "Sleeping" of the glibc manual:
+		 * On GNU system, it is safe to use sleep and SIGALRM in the
+		 * same program, because sleep does not work by means of
+		 * SIGALRM.
+		 */
+		err = sigaction(SIGALRM, &tmr, &cute_run_timer_act);
+		cute_assert_intern(!err);
 	}
 }
 
@@ -173,12 +239,14 @@ cute_run_unsettle_sigs(void)
 {
 	if (!cute_the_config->debug) {
 		unsigned int s;
+		int          err __cute_unused;
+
+		err = sigaction(SIGALRM, &cute_run_timer_act, NULL);
+		cute_assert_intern(!err);
 
 		for (s = 0;
 		     s < (sizeof(cute_run_sigs) / sizeof(cute_run_sigs[0]));
 		     s++) {
-			int err __cute_unused;
-
 			err = sigaction(cute_run_sigs[s].sig,
 			                &cute_run_sigs[s].old,
 			                NULL);
@@ -187,55 +255,41 @@ cute_run_unsettle_sigs(void)
 	}
 }
 
+/*
+ * Arm timer so that it expires after sec seconds plus msec milliseconds or
+ * disarm it when both are zero.
+ */
 static void
-cute_run_handle_tmout(int         sig __cute_unused,
-                      siginfo_t * info __cute_unused,
-                      void *      context __cute_unused)
+cute_run_set_timer(timer_t timer, time_t sec, unsigned int msec)
 {
-	cute_assert_intern(sig == SIGALRM);
-	cute_run_assert_intern(cute_curr_run);
-
-	if (cute_curr_run->issue != CUTE_UNK_ISSUE)
-		/*
-		 * Test case has completed but timer has not yet been disabled:
-		 * Ignore the timeout.
-		 */
-		return;
-
-	cute_assess_release(&cute_curr_run->assess);
-	cute_assess_build_expr(&cute_curr_run->assess, NULL);
-	cute_break(CUTE_FAIL_ISSUE,
-	           cute_curr_run->base->file,
-	           cute_curr_run->base->line,
-	           NULL,
-	           "timer expired");
+	int                     err __cute_unused;
+	const struct itimerspec spec = {
+		.it_value = {
+			.tv_sec  = sec + (time_t)(msec / 1000U),
+			.tv_nsec = (long)(msec % 1000U) * 1000000L
+		}
+	};
 
-	siglongjmp(cute_jmp_env, CUTE_FAIL_ISSUE);
+	err = timer_settime(timer, 0, &spec, NULL);
+	cute_assert_intern(!err);
 }
 
 static void
 cute_run_arm_timer(const struct cute_run * run)
 {
 	if (!cute_the_config->debug) {
-		/*
-		 * As stated into section "Sleeping" of the glibc manual:
-		 * On GNU system, it is safe to use sleep and SIGALRM in the
-		 * same program, because sleep does not work by means of
-		 * SIGALRM.
-		 */
-		if (run->tmout > 0) {
-			int                    err __cute_unused;
-			const struct sigaction act = {
-				.sa_sigaction = cute_run_handle_tmout,
-				.sa_mask      = cute_run_sigmask,
-				.sa_flags     = SA_SIGINFO | SA_ONSTACK
-			};
-
-			err = sigaction(SIGALRM, &act, &cute_run_timer_act);
-			cute_assert_intern(!err);
-
-			alarm(run->tmout);
-		}
+		if (run->tmout & CUTE_MSEC_TMOUT_FLAG)
+			cute_run_set_timer(cute_run_timer,
+			                   0,
+			                   run->tmout & ~CUTE_MSEC_TMOUT_FLAG);
+		else if (run->tmout > 0)
+			cute_run_set_timer(cute_run_timer,
+			                   (time_t)run->tmout,
+			                   0);
+		if (cute_the_config->cpu_tmout > 0)
+			cute_run_set_timer(cute_run_cpu_timer,
+			                   0,
+			                   cute_the_config->cpu_tmout);
 	}
 }
 
@@ -243,14 +297,10 @@ static void
 cute_run_disarm_timer(const struct cute_run * run)
 {
 	if (!cute_the_config->debug) {
-		if (run->tmout > 0) {
-			int err __cute_unused;
-
-			alarm(0);
-
-			err = sigaction(SIGALRM, &cute_run_timer_act, NULL);
-			cute_assert_intern(!err);
-		}
+		if (run->tmout > 0)
+			cute_run_set_timer(cute_run_timer, 0, 0);
+		if (cute_the_config->cpu_tmout > 0)
+			cute_run_set_timer(cute_run_cpu_timer, 0, 0);
 	}
 }
 
@@ -259,7 +309,7 @@ cute_run_block_sigs(sigset_t * old)
 {
 	int err __cute_unused;
 
-	err = sigprocmask(SIG_BLOCK, &cute_run_blksig, old);
+	err = pthread_sigmask(SIG_BLOCK, &cute_run_blksig, old);
 	cute_assert_intern(!err);
 }
 
@@ -268,11 +318,88 @@ cute_run_unblock_sigs(const sigset_t * old)
 {
 	int err __cute_unused;
 
-	err = sigprocmask(SIG_SETMASK, old, NULL);
+	err = pthread_sigmask(SIG_SETMASK, old, NULL);
 	cute_assert_intern(!err);
 }
 
+static int
+cute_run_create_timer(void)
+{
+	struct sigevent evt = {
+		.sigev_notify = SIGEV_THREAD_ID,
+		.sigev_signo  = SIGALRM,
+		.sigev_value  = { .sival_int = CUTE_RUN_WALL_TIMER }
+	};
+
+	/*
+	 * Timer expiration must interrupt the thread running the test that
+	 * armed it.
+	 */
+	evt.sigev_notify_thread_id = gettid();
+	if (timer_create(CLOCK_MONOTONIC, &evt, &cute_run_timer))
+		return -errno;
+
+	/*
+	 * CPU time budget timer measures CPU time consumed by the thread
+	 * running the test only so that tests run concurrently by other
+	 * threads are not accounted for.
+	 */
+	evt.sigev_value.sival_int = CUTE_RUN_CPU_TIMER;
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &evt, &cute_run_cpu_timer)) {
+		int err = errno;
+
+		timer_delete(cute_run_timer);
+
+		return -err;
+	}
+
+	return 0;
+}
+
+int
+cute_run_init_thread_sigs(void)
+{
+	if (!cute_the_config->debug) {
+		int err;
+
+		err = cute_run_create_timer();
+		if (err)
+			return err;
+
+		cute_run_sigstack.ss_flags = 0;
+		cute_run_sigstack.ss_size = (size_t)SIGSTKSZ;
+		cute_run_sigstack.ss_sp = cute_malloc((size_t)SIGSTKSZ);
+		err = sigaltstack(&cute_run_sigstack, NULL);
+		cute_assert_intern(!err);
+
+		/* Threads are spawned with all signals blocked. */
+		err = pthread_sigmask(SIG_UNBLOCK, &cute_run_sigmask, NULL);
+		cute_assert_intern(!err);
+	}
+
+	return 0;
+}
+
 void
+cute_run_fini_thread_sigs(void)
+{
+	if (!cute_the_config->debug) {
+		const stack_t stk = { .ss_flags = SS_DISABLE };
+		int           err __cute_unused;
+
+		err = sigaltstack(&stk, NULL);
+		cute_assert_intern(!err);
+
+		cute_free(cute_run_sigstack.ss_sp);
+
+		err = timer_delete(cute_run_cpu_timer);
+		cute_assert_intern(!err);
+		err = timer_delete(cute_run_timer);
+		cute_assert_intern(!err);
+	}
+}
+
+int
 cute_run_init_sigs(void)
 {
 	int err __cute_unused;
@@ -291,41 +418,81 @@ cute_run_init_sigs(void)
 			                cute_run_sigs[s].sig);
 			cute_assert_intern(!err);
 		}
-
-		cute_run_sigstack.ss_size = (size_t)SIGSTKSZ;
-		cute_run_sigstack.ss_sp = cute_malloc((size_t)SIGSTKSZ);
-		err = sigaltstack(&cute_run_sigstack, NULL);
-		cute_assert_intern(!err);
 	}
 
 	sigemptyset(&cute_run_blksig);
 	err = sigaddset(&cute_run_blksig, SIGALRM);
 	cute_assert_intern(!err);
+
+	return cute_run_init_thread_sigs();
 }
 
 void
 cute_run_fini_sigs(void)
 {
-	if (!cute_the_config->debug) {
-		const stack_t stk = { .ss_flags = SS_DISABLE };
-		int           err __cute_unused;
+	cute_run_fini_thread_sigs();
+}
 
-		err = sigaltstack(&stk, NULL);
-		cute_assert_intern(!err);
+int
+cute_run_respawn_sigs(void)
+{
+	/*
+	 * Timers are not inherited by fork(2)'ed children whereas the
+	 * alternate signal stack is.
+	 */
+	if (!cute_the_config->debug)
+		return cute_run_create_timer();
 
-		cute_free(cute_run_sigstack.ss_sp);
-	}
+	return 0;
 }
 
 void
-cute_run_settle(struct cute_run * run)
+cute_run_share(struct cute_run * run)
 {
 	cute_run_assert_intern(run);
+	cute_assert_intern(!cute_run_shared);
 
 	cute_run_settle_sigs();
 
 	cute_iodir_redirect(&run->ioout, &run->ioerr);
 
+	cute_run_shared = true;
+}
+
+void
+cute_run_unshare(struct cute_run * run __cute_unused)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(cute_run_shared);
+
+	cute_run_shared = false;
+
+	cute_iodir_restore();
+
+	cute_run_unsettle_sigs();
+}
+
+/*
+ * Return true when tests of a threaded suite are being run concurrently, i.e.
+ * when process-wide resources are shared among tests.
+ */
+bool
+cute_run_is_shared(void)
+{
+	return cute_run_shared;
+}
+
+void
+cute_run_settle(struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+
+	if (!cute_run_shared) {
+		cute_run_settle_sigs();
+
+		cute_iodir_redirect(&run->ioout, &run->ioerr);
+	}
+
 	cute_run_arm_timer(run);
 }
 
@@ -336,9 +503,11 @@ cute_run_unsettle(struct cute_run * run)
 
 	cute_run_disarm_timer(run);
 
-	cute_iodir_restore();
+	if (!cute_run_shared) {
+		cute_iodir_restore();
 
-	cute_run_unsettle_sigs();
+		cute_run_unsettle_sigs();
+	}
 }
 
 int
@@ -371,11 +540,27 @@ cute_run_done(struct cute_run * run)
 			run->assess.file = run->base->file;
 			run->assess.line = run->base->line;
 		}
+		else if (run->heap.leaks) {
+			run->issue = CUTE_FAIL_ISSUE;
+			run->what = cute_run_what(run, CUTE_FAIL_ISSUE);
+			run->why = "heap blocks left allocated";
+			run->assess.file = run->base->file;
+			run->assess.line = run->base->line;
+		}
+		else if (run->leaks) {
+			run->issue = CUTE_FAIL_ISSUE;
+			run->what = cute_run_what(run, CUTE_FAIL_ISSUE);
+			run->why = run->leaks;
+			run->assess.file = run->base->file;
+			run->assess.line = run->base->line;
+		}
 		else
 			run->issue = CUTE_PASS_ISSUE;
 
 	}
-	else if (run->issue != CUTE_OFF_ISSUE) {
+	else if ((run->issue != CUTE_OFF_ISSUE) &&
+	         (run->issue != CUTE_CUT_ISSUE) &&
+	         !run->cached) {
 		cute_assert_intern(run->what);
 		cute_assert_intern(run->why);
 		cute_assert_intern(run->assess.file);
@@ -394,6 +579,7 @@ cute_run_done(struct cute_run * run)
 	case CUTE_PASS_ISSUE:
 	case CUTE_SKIP_ISSUE:
 	case CUTE_OFF_ISSUE:
+	case CUTE_CUT_ISSUE:
 		ret = 0;
 		break;
 
@@ -410,6 +596,63 @@ cute_run_done(struct cute_run * run)
 	return ret;
 }
 
+/*
+ * Report events recorded while reporting was diverted (see
+ * cute_report_divert()) on behalf of a completed test.
+ */
+void
+cute_run_replay(struct cute_run * run, unsigned int events)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(events & (1U << CUTE_DONE_EVT));
+
+	static const enum cute_state states[] = {
+		[CUTE_SETUP_EVT]    = CUTE_SETUP_STATE,
+		[CUTE_EXEC_EVT]     = CUTE_EXEC_STATE,
+		[CUTE_TEARDOWN_EVT] = CUTE_TEARDOWN_STATE
+	};
+	unsigned int                 evt;
+
+	for (evt = CUTE_SETUP_EVT; evt < CUTE_DONE_EVT; evt++) {
+		if (events & (1U << evt)) {
+			run->state = states[evt];
+			cute_run_report(run, (enum cute_event)evt);
+		}
+	}
+
+	run->state = CUTE_DONE_STATE;
+	cute_run_report(run, CUTE_DONE_EVT);
+}
+
+/*
+ * Account for outcome of a completed test so that run may be cut short once
+ * enough of them have failed.
+ */
+void
+cute_run_tally(const struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(run->issue != CUTE_UNK_ISSUE);
+	cute_assert_intern(run->issue < CUTE_ISSUE_NR);
+
+	if ((run->issue == CUTE_FAIL_ISSUE) || (run->issue == CUTE_EXCP_ISSUE))
+		__atomic_add_fetch(&cute_run_fails, 1U, __ATOMIC_RELAXED);
+}
+
+/*
+ * Return true when enough tests have failed so that no more tests should be
+ * run, i.e. when run is cut short.
+ */
+bool
+cute_run_cut(void)
+{
+	cute_config_assert_intern(cute_the_config);
+
+	return cute_the_config->fail_fast &&
+	       (__atomic_load_n(&cute_run_fails, __ATOMIC_RELAXED) >=
+	        cute_the_config->fail_fast);
+}
+
 void
 cute_run_oper(struct cute_run * run, enum cute_oper oper)
 {
@@ -442,6 +685,8 @@ cute_run_turn_on(struct cute_run * run)
 	} while (run && (run->state == CUTE_OFF_STATE));
 }
 
+struct cute_arena cute_run_arena = CUTE_ARENA_INIT;
+
 static char *
 cute_run_build_name(const struct cute_base * base,
                     const struct cute_run *  parent)
@@ -457,7 +702,7 @@ cute_run_build_name(const struct cute_base * base,
 		plen = strnlen(parent->name, CUTE_FULL_NAME_MAX_LEN + 1);
 		cute_assert((blen + 2 + plen) <= CUTE_FULL_NAME_MAX_LEN);
 
-		name = cute_malloc(plen + 2 + blen + 1);
+		name = cute_run_alloc(plen + 2 + blen + 1);
 
 		memcpy(name, parent->name, plen);
 		name[plen++] = ':';
@@ -465,7 +710,7 @@ cute_run_build_name(const struct cute_base * base,
 	}
 	else {
 		plen = 0;
-		name = cute_malloc(blen + 1);
+		name = cute_run_alloc(blen + 1);
 	}
 
 	memcpy(&name[plen], base->name, blen);
@@ -488,10 +733,18 @@ cute_run_init(struct cute_run *           run,
 	run->name = cute_run_build_name(base, parent);
 	run->parent = parent;
 	run->id = -1;
+	run->order = 0;
+	run->order_end = 0;
 	run->base = base;
+	run->cached = false;
+	memset(&run->repeat, 0, sizeof(run->repeat));
 	run->issue = CUTE_UNK_ISSUE;
-	run->begin.tv_sec = run->begin.tv_nsec = 0;
-	run->end.tv_sec = run->end.tv_nsec = 0;
+	memset(&run->stamp, 0, sizeof(run->stamp));
+	memset(&run->times, 0, sizeof(run->times));
+	memset(&run->usage, 0, sizeof(run->usage));
+	memset(&run->perf, 0, sizeof(run->perf));
+	memset(&run->heap, 0, sizeof(run->heap));
+	run->leaks = NULL;
 	run->what = NULL;
 	run->why = NULL;
 	cute_assess_build_null(&run->assess);
@@ -564,121 +817,247 @@ cute_run_fini(struct cute_run * run)
 	cute_iodir_fini_block(&run->ioout);
 	cute_iodir_fini_block(&run->ioerr);
 	cute_assess_release(&run->assess);
-	cute_free(run->name);
 }
 
+/*
+ * Run memory itself is released along with cute_run_arena.
+ */
 void
 cute_run_destroy(struct cute_run * run)
 {
 	cute_run_assert_intern(run);
 
 	cute_run_fini(run);
-	cute_free(run);
 }
 
-static struct cute_iter *
-cute_run_create_iter(struct cute_run * run)
+static bool
+cute_run_init_iter(struct cute_run * run, struct cute_iter * iter)
 {
 	cute_run_assert_intern(run);
+	cute_assert_intern(iter);
 
-	return run->ops->iter(run);
+	return run->ops->iter(run, iter);
 }
 
-void
-cute_run_foreach(struct cute_run *     run,
-                 cute_run_process_fn * process,
-                 void *                data)
+/*
+ * Pre-order table of run tree nodes.
+ *
+ * Once the tree is indexed, each node is given its rank into the table as
+ * well as the rank following its last descendant so that the nodes of any
+ * subtree are found contiguously into the table. Tree walks are then plain
+ * linear scans of the table.
+ */
+static struct cute_run ** cute_run_table;
+static unsigned int       cute_run_table_nr;
+static unsigned int       cute_run_table_max;
+
+static void
+cute_run_index_node(struct cute_run * run)
 {
 	cute_run_assert_intern(run);
-	cute_assert_intern(process);
 
-	struct cute_iter * iter;
-	struct cute_stack  stk;
+	if (cute_run_table_nr == cute_run_table_max) {
+		cute_run_table_max = cute_run_table_max ?
+		                     (2 * cute_run_table_max) : 64;
+		cute_run_table = cute_realloc(cute_run_table,
+		                              cute_run_table_max *
+		                              sizeof(cute_run_table[0]));
+	}
 
-	iter = cute_run_create_iter(run);
-	cute_assert_intern(iter);
+	run->order = cute_run_table_nr;
+	cute_run_table[cute_run_table_nr++] = run;
+}
+
+/*
+ * Full name to run hash index.
+ *
+ * Open addressing table with linear probing, sized to a power of 2 at least
+ * twice as large as the number of nodes so that probe sequences stay short.
+ * Slots point to run tree nodes and are rebuilt along with the pre-order table.
+ */
+static struct cute_run ** cute_run_hash;
+static unsigned int       cute_run_hash_mask;
+
+static void
+cute_run_hash_node(struct cute_run * run)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(cute_run_hash);
 
-	cute_stack_init(&stk);
-	cute_stack_push(&stk, iter);
+	unsigned int slot = cute_match_hash(run->name) & cute_run_hash_mask;
 
-	process(run, CUTE_BEGIN_VISIT, data);
+	/* Keep the first node in pre-order for duplicate names. */
+	while (cute_run_hash[slot]) {
+		if (!strcmp(cute_run_hash[slot]->name, run->name))
+			return;
+		slot = (slot + 1) & cute_run_hash_mask;
+	}
+
+	cute_run_hash[slot] = run;
+}
+
+static void
+cute_run_hash_tree(void)
+{
+	cute_assert_intern(cute_run_table_nr);
+
+	unsigned int size = 64;
+	unsigned int r;
+
+	while (size < (2 * cute_run_table_nr))
+		size *= 2;
+
+	if (size != (cute_run_hash_mask + 1)) {
+		cute_free(cute_run_hash);
+		cute_run_hash = cute_malloc(size * sizeof(cute_run_hash[0]));
+		cute_run_hash_mask = size - 1;
+	}
+	memset(cute_run_hash, 0, size * sizeof(cute_run_hash[0]));
+
+	for (r = 0; r < cute_run_table_nr; r++)
+		cute_run_hash_node(cute_run_table[r]);
+}
+
+/*
+ * (Re)build the pre-order table according to current order of suite children.
+ * Must be called again whenever children are re-ordered.
+ */
+void
+cute_run_index_tree(struct cute_run * root)
+{
+	cute_run_assert_intern(root);
+	cute_assert_intern(!root->parent);
+
+	struct cute_iter iters[CUTE_DEPTH_MAX];
+	unsigned int     cnt = 1;
+
+	cute_run_table_nr = 0;
+
+	cute_run_index_node(root);
+	if (!cute_run_init_iter(root, &iters[0])) {
+		/* Nothing selected. */
+		root->order_end = cute_run_table_nr;
+		cute_run_hash_tree();
+		return;
+	}
 
 	do {
-		iter = cute_stack_peek(&stk);
-		cute_assert_intern(iter);
-		if (!cute_iter_end(iter)) {
-			enum cute_visit visit = CUTE_ONCE_VISIT;
+		struct cute_iter * iter = &iters[cnt - 1];
+		struct cute_run *  run;
 
+		if (!cute_iter_end(iter)) {
 			run = cute_iter_next(iter);
-			iter = cute_run_create_iter(run);
-			if (iter) {
-				cute_stack_push(&stk, iter);
-				visit = CUTE_BEGIN_VISIT;
-			}
+			cute_run_index_node(run);
 
-			process(run, visit, data);
+			cute_assert(cnt < CUTE_DEPTH_MAX);
+			if (cute_run_init_iter(run, &iters[cnt]))
+				cnt++;
+			else
+				run->order_end = cute_run_table_nr;
 			continue;
 		}
 
 		run = cute_iter_data(iter);
 		cute_assert_intern(run);
-		process(run, CUTE_END_VISIT, data);
+		run->order_end = cute_run_table_nr;
 
-		cute_stack_pop(&stk);
-		cute_iter_destroy(iter);
-	} while (cute_stack_count(&stk));
+		cnt--;
+	} while (cnt);
 
-	cute_stack_fini(&stk);
+	cute_run_hash_tree();
 }
 
-struct cute_run *
-cute_run_find(struct cute_run * run, const char * name)
+void
+cute_run_release_tree(void)
 {
-	cute_run_assert_intern(run);
-	cute_assert_intern(name);
-	cute_assert_intern(name[0]);
+	cute_free(cute_run_hash);
+	cute_run_hash = NULL;
+	cute_run_hash_mask = 0;
 
-	struct cute_iter * iter;
-	struct cute_stack  stk;
+	cute_free(cute_run_table);
+	cute_run_table = NULL;
+	cute_run_table_nr = 0;
+	cute_run_table_max = 0;
 
-	iter = cute_run_create_iter(run);
-	cute_assert_intern(iter);
+	cute_arena_release(&cute_run_arena);
+}
 
-	cute_stack_init(&stk);
-	cute_stack_push(&stk, iter);
+#define cute_run_assert_indexed_intern(_run) \
+	cute_assert_intern((_run)->order < (_run)->order_end); \
+	cute_assert_intern((_run)->order_end <= cute_run_table_nr); \
+	cute_assert_intern(cute_run_table[(_run)->order] == (_run))
 
-	do {
-		iter = cute_stack_peek(&stk);
-		cute_assert_intern(iter);
+void
+cute_run_foreach(struct cute_run *     run,
+                 cute_run_process_fn * process,
+                 void *                data)
+{
+	cute_run_assert_intern(run);
+	cute_run_assert_indexed_intern(run);
+	cute_assert_intern(process);
 
-		if (cute_iter_end(iter)) {
-			cute_stack_pop(&stk);
-			cute_iter_destroy(iter);
-			continue;
+	/* Suites whose END visit is pending, innermost last. */
+	struct cute_run * open[CUTE_DEPTH_MAX];
+	unsigned int      cnt = 0;
+	unsigned int      r;
+
+	for (r = run->order; r < run->order_end; r++) {
+		struct cute_run * curr = cute_run_table[r];
+
+		while (cnt && (open[cnt - 1]->order_end <= r))
+			process(open[--cnt], CUTE_END_VISIT, data);
+
+		/* Suites left without any selected child are visited too. */
+		if (curr->base->ops != &cute_test_ops) {
+			cute_assert_intern(cnt < CUTE_DEPTH_MAX);
+			open[cnt++] = curr;
+			process(curr, CUTE_BEGIN_VISIT, data);
 		}
+		else
+			process(curr, CUTE_ONCE_VISIT, data);
+	}
 
-		run = cute_iter_next(iter);
-		if (!strcmp(run->name, name))
-			goto found;
+	while (cnt)
+		process(open[--cnt], CUTE_END_VISIT, data);
+}
 
-		iter = cute_run_create_iter(run);
-		if (iter)
-			cute_stack_push(&stk, iter);
-	} while (cute_stack_count(&stk));
+struct cute_run *
+cute_run_lookup(const char * name)
+{
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+	cute_assert_intern(cute_run_hash);
 
-	run = NULL;
-	goto fini;
+	unsigned int slot = cute_match_hash(name) & cute_run_hash_mask;
 
-found:
-	while (cute_stack_count(&stk)) {
-		iter = cute_stack_pop(&stk);
-		cute_iter_destroy(iter);
+	while (cute_run_hash[slot]) {
+		if (!strcmp(cute_run_hash[slot]->name, name))
+			return cute_run_hash[slot];
+		slot = (slot + 1) & cute_run_hash_mask;
 	}
 
-fini:
-	cute_stack_fini(&stk);
+	return NULL;
+}
+
+struct cute_run *
+cute_run_find(struct cute_run * run, const char * name)
+{
+	cute_run_assert_intern(run);
+	cute_assert_intern(name);
+	cute_assert_intern(name[0]);
+
+	struct cute_run * found;
+
+	cute_run_assert_indexed_intern(run);
+
+	found = cute_run_lookup(name);
+	if (!found ||
+	    (found->order <= run->order) ||
+	    (found->order >= run->order_end))
+		/* Not a descendant of run. */
+		return NULL;
 
-	return run;
+	return found;
 }
 
 void
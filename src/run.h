@@ -11,6 +11,8 @@
 #include "expect.h"
 #include "report.h"
 #include "iodir.h"
+#include "perf.h"
+#include "heap.h"
 #include "util.h"
 #include <signal.h>
 
@@ -27,14 +29,16 @@ struct cute_stats {
 	unsigned int fail;
 	unsigned int excp;
 	unsigned int exec;
+	unsigned int cut;
+	unsigned int cached;
 	unsigned int total;
 };
 
 typedef void
         (cute_run_report_fn)(const struct cute_run *, enum cute_event);
 
-typedef struct cute_iter *
-        (cute_run_iter_fn)(struct cute_run *);
+typedef bool
+        (cute_run_iter_fn)(struct cute_run *, struct cute_iter *);
 
 typedef void
         (cute_run_oper_fn)(struct cute_run *, enum cute_oper);
@@ -77,20 +81,83 @@ struct cute_run_ops {
 
 #endif /* defined(CONFIG_CUTE_INTERN_ASSERT) */
 
+/*
+ * Outcome of a test run multiple times according to cute_config::repeat.
+ * Durations are given in microseconds.
+ */
+struct cute_repeat {
+	unsigned int  runs;
+	unsigned int  pass;
+	unsigned int  fail;
+	unsigned long min;
+	unsigned long med;
+	unsigned long p95;
+	unsigned long max;
+};
+
+/*
+ * Monotonic clock timestamps bounding a run phase. Both are left zeroed when
+ * phase is not entered.
+ */
+struct cute_span {
+	struct timespec begin;
+	struct timespec end;
+};
+
+static inline void
+cute_span_diff(struct timespec * diff, const struct cute_span * span)
+{
+	cute_diff_tspec(diff, &span->begin, &span->end);
+}
+
+/*
+ * Tests record the time spent into setup fixture, test function and teardown
+ * fixture separately. Suites record the time spent running all of their
+ * descendants into exec span.
+ */
+struct cute_times {
+	struct cute_span setup;
+	struct cute_span exec;
+	struct cute_span teardown;
+};
+
+/*
+ * Resources consumed by a test function as reported by getrusage(2) for the
+ * thread running it. CPU times are given in microseconds and maximum resident
+ * set size growth in kilobytes.
+ */
+struct cute_usage {
+	long utime;
+	long stime;
+	long minflt;
+	long majflt;
+	long nvcsw;
+	long nivcsw;
+	long maxrss;
+};
+
 struct cute_run {
 	const struct cute_run_ops *     ops;
 	char *                          name;
 	struct cute_run *               parent;
 	int                             depth;
 	int                             id;
+	unsigned int                    order;
+	unsigned int                    order_end;
 	const struct cute_base *        base;
 	cute_test_fn *                  setup;
 	cute_test_fn *                  teardown;
 	enum cute_state                 state;
 	unsigned int                    tmout;
+	bool                            cached;
+	struct cute_repeat              repeat;
 	enum cute_issue                 issue;
-	struct timespec                 begin;
-	struct timespec                 end;
+	struct timespec                 stamp;
+	struct cute_times               times;
+	struct cute_usage               usage;
+	struct cute_perf                perf;
+	struct cute_heap                heap;
+	const char *                    leaks;
 	const char *                    what;
 	const char *                    why;
 	union {
@@ -139,15 +206,35 @@ cute_run_dummy_fini(struct cute_run * run __cute_unused)
 	cute_run_assert_intern(run);
 }
 
+extern bool
+cute_run_is_shared(void);
+
 extern void
 cute_run_settle(struct cute_run * run);
 
 extern void
 cute_run_unsettle(struct cute_run * run);
 
+extern void
+cute_run_share(struct cute_run * run);
+
+extern void
+cute_run_unshare(struct cute_run * run);
+
 extern int
 cute_run_done(struct cute_run * run);
 
+extern unsigned int cute_run_fails;
+
+extern void
+cute_run_replay(struct cute_run * run, unsigned int events);
+
+extern void
+cute_run_tally(const struct cute_run * run);
+
+extern bool
+cute_run_cut(void);
+
 static inline void
 cute_run_sum_stats(const struct cute_run * run, struct cute_stats * stats)
 {
@@ -173,6 +260,18 @@ cute_run_report(const struct cute_run * run, enum cute_event event)
 extern void
 cute_run_turn_on(struct cute_run * run);
 
+/*
+ * Run tree nodes and their full names are allocated from this arena which is
+ * released at once when the tree is torn down.
+ */
+extern struct cute_arena cute_run_arena;
+
+static inline void *
+cute_run_alloc(size_t size)
+{
+	return cute_arena_alloc(&cute_run_arena, size);
+}
+
 extern void
 cute_run_init(struct cute_run *           run,
               const struct cute_run_ops * ops,
@@ -188,24 +287,42 @@ cute_run_block_sigs(sigset_t * old);
 extern void
 cute_run_unblock_sigs(const sigset_t * old);
 
+extern int
+cute_run_init_thread_sigs(void);
+
 extern void
+cute_run_fini_thread_sigs(void);
+
+extern int
 cute_run_init_sigs(void);
 
 extern void
 cute_run_fini_sigs(void);
 
+extern int
+cute_run_respawn_sigs(void);
+
 typedef void
         (cute_run_process_fn)(struct cute_run *, enum cute_visit, void *);
 
+extern void
+cute_run_index_tree(struct cute_run * root);
+
+extern void
+cute_run_release_tree(void);
+
 extern void
 cute_run_foreach(struct cute_run *     run,
                  cute_run_process_fn * process,
                  void *                data);
 
+extern struct cute_run *
+cute_run_lookup(const char * name);
+
 extern struct cute_run *
 cute_run_find(struct cute_run * run, const char * name);
 
-extern struct cute_run * volatile cute_curr_run;
+extern __thread struct cute_run * volatile cute_curr_run;
 
 extern void
 cute_break(enum cute_issue issue,
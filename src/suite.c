@@ -6,7 +6,12 @@
  ******************************************************************************/
 
 #include "suite.h"
+#include "pool.h"
+#include "cache.h"
+#include "cov.h"
+#include "bisect.h"
 #include "report.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -37,16 +42,21 @@ cute_suite_report(const struct cute_run * run, enum cute_event event)
 	cute_report_suite(event, run);
 }
 
-static struct cute_iter *
-cute_suite_run_iter(struct cute_run * run)
+static bool
+cute_suite_run_iter(struct cute_run * run, struct cute_iter * iter)
 {
 	cute_run_assert_intern(run);
 	cute_suite_assert_intern((const struct cute_suite *)run->base);
 
-	return cute_iter_create((void * const *)
-	                        ((struct cute_suite_run *)run)->subs,
-	                        ((const struct cute_suite *)run->base)->nr,
-	                        run);
+	const struct cute_suite_run * srun = (struct cute_suite_run *)run;
+
+	/* Children left unselected have no run. */
+	if (!srun->count)
+		return false;
+
+	cute_iter_init(iter, (void * const *)srun->subs, srun->count, run);
+
+	return true;
 }
 
 static void
@@ -63,6 +73,7 @@ cute_suite_complete_run(struct cute_suite_run * run)
 	cute_assert_intern(!run->stats.fail);
 	cute_assert_intern(!run->stats.excp);
 	cute_assert_intern(!run->stats.exec);
+	cute_assert_intern(!run->stats.cut);
 	cute_assert_intern(run->stats.total);
 
 	unsigned int s;
@@ -73,7 +84,7 @@ cute_suite_complete_run(struct cute_suite_run * run)
 
 		run->super.state = CUTE_TEARDOWN_STATE;
 		cute_run_report(&run->super, CUTE_TEARDOWN_EVT);
-		cute_gettime(&run->super.end);
+		cute_gettime(&run->super.times.exec.end);
 	}
 
 	memset(&run->sums, 0, sizeof(run->sums));
@@ -107,6 +118,10 @@ cute_suite_complete_run(struct cute_suite_run * run)
 			run->stats.exec++;
 			break;
 
+		case CUTE_CUT_ISSUE:
+			run->stats.cut++;
+			break;
+
 		default:
 			__cute_unreachable();
 		}
@@ -114,24 +129,37 @@ cute_suite_complete_run(struct cute_suite_run * run)
 		cute_run_sum_stats(run->subs[s], &run->sums);
 	}
 
-	if (run->super.issue == CUTE_UNK_ISSUE) {
-		if (run->stats.skip == run->stats.exec) {
-			cute_assert_intern(!run->stats.fail);
-			cute_assert_intern(!run->stats.excp);
+	/* Account for unselected tests which have no run. */
+	cute_assert_intern(run->sums.total <= run->tests);
+	run->sums.total = run->tests;
 
-			run->super.issue = CUTE_SKIP_ISSUE;
-			run->super.what = "exec skipped";
-			run->super.why = "all descendants skipped";
+	if (run->super.issue == CUTE_UNK_ISSUE) {
+		if (run->stats.fail || run->stats.excp) {
+			run->super.issue = CUTE_FAIL_ISSUE;
+			run->super.what = "exec failed";
+			run->super.why = "descendants failed";
 			cute_assess_update_source(&run->super.assess,
 			                          run->super.base->file,
 			                          run->super.base->line,
 			                          NULL);
 			cute_assess_build_expr(&run->super.assess, NULL);
 		}
-		else if (run->stats.fail || run->stats.excp) {
-			run->super.issue = CUTE_FAIL_ISSUE;
-			run->super.what = "exec failed";
-			run->super.why = "descendants failed";
+		else if (run->stats.cut) {
+			/*
+			 * Run cut short before all descendants could complete:
+			 * do not pretend suite passed.
+			 */
+			run->super.issue = CUTE_CUT_ISSUE;
+			run->super.what = "exec cut short";
+			run->super.why = "descendants not run";
+		}
+		else if (run->stats.skip == run->stats.exec) {
+			cute_assert_intern(!run->stats.fail);
+			cute_assert_intern(!run->stats.excp);
+
+			run->super.issue = CUTE_SKIP_ISSUE;
+			run->super.what = "exec skipped";
+			run->super.why = "all descendants skipped";
 			cute_assess_update_source(&run->super.assess,
 			                          run->super.base->file,
 			                          run->super.base->line,
@@ -153,6 +181,7 @@ cute_suite_oper_run(struct cute_run * run, enum cute_oper oper)
 	cute_assert_intern(!((struct cute_suite_run *)run)->stats.fail);
 	cute_assert_intern(!((struct cute_suite_run *)run)->stats.excp);
 	cute_assert_intern(!((struct cute_suite_run *)run)->stats.exec);
+	cute_assert_intern(!((struct cute_suite_run *)run)->stats.cut);
 	cute_assert_intern(((struct cute_suite_run *)run)->stats.total);
 
 	switch (oper) {
@@ -162,7 +191,8 @@ cute_suite_oper_run(struct cute_run * run, enum cute_oper oper)
 			break;
 		}
 
-		cute_gettime(&run->begin);
+		cute_getstamp(&run->stamp);
+		cute_gettime(&run->times.exec.begin);
 		run->state = CUTE_SETUP_STATE;
 		cute_run_report(run, CUTE_SETUP_EVT);
 		break;
@@ -194,6 +224,8 @@ cute_suite_sum_run(const struct cute_run * run, struct cute_stats * sums)
 	sums->fail += stats->fail;
 	sums->excp += stats->excp;
 	sums->exec += stats->exec;
+	sums->cut += stats->cut;
+	sums->cached += stats->cached;
 	sums->total += stats->total;
 }
 
@@ -215,6 +247,7 @@ cute_suite_join_run(struct cute_run * run, struct cute_run * sub)
 	cute_assert_intern(!srun->stats.fail);
 	cute_assert_intern(!srun->stats.excp);
 	cute_assert_intern(!srun->stats.exec);
+	cute_assert_intern(!srun->stats.cut);
 	cute_assert_intern(srun->count < suite->nr);
 
 	sub->id = (int)srun->count;
@@ -239,13 +272,14 @@ cute_suite_run(const struct cute_base * suite, struct cute_run * parent)
 	unsigned int            nr = ((const struct cute_suite *)suite)->nr;
 	unsigned int            s;
 
-	run = cute_malloc(sizeof(*run) + (nr * sizeof(run->subs[0])));
+	run = cute_run_alloc(sizeof(*run) + (nr * sizeof(run->subs[0])));
 
 	for (s = 0; s < nr; s++)
 		run->subs[s] = NULL;
 
 	memset(&run->stats, 0, sizeof(run->stats));
 	run->stats.total = nr;
+	run->tests = 0;
 	run->count = 0;
 
 	cute_run_init(&run->super, &cute_suite_run_ops, suite, parent);
@@ -253,15 +287,18 @@ cute_suite_run(const struct cute_base * suite, struct cute_run * parent)
 	return &run->super;
 }
 
-static struct cute_iter *
-cute_suite_iter(const struct cute_base * suite)
+static bool
+cute_suite_iter(const struct cute_base * suite, struct cute_iter * iter)
 {
 	cute_suite_assert_intern((const struct cute_suite *)suite);
 
-	return cute_iter_const_create((const void * const *)
-	                              ((const struct cute_suite *)suite)->tests,
-	                              ((const struct cute_suite *)suite)->nr,
-	                              suite);
+	cute_iter_const_init(iter,
+	                     (const void * const *)
+	                     ((const struct cute_suite *)suite)->tests,
+	                     ((const struct cute_suite *)suite)->nr,
+	                     suite);
+
+	return true;
 }
 
 const struct cute_ops cute_suite_ops = {
@@ -269,6 +306,15 @@ const struct cute_ops cute_suite_ops = {
 	.run  = cute_suite_run
 };
 
+/*
+ * Threaded suites are run the same way as regular ones: their ops are only
+ * used to tell them apart when walking the run tree.
+ */
+const struct cute_ops cute_thread_suite_ops = {
+	.iter = cute_suite_iter,
+	.run  = cute_suite_run
+};
+
 /******************************************************************************
  * Run tree handling
  ******************************************************************************/
@@ -285,13 +331,25 @@ cute_suite_oper_tree_run(struct cute_run * run,
 	switch (visit) {
 	case CUTE_BEGIN_VISIT:
 		cute_run_oper(run, CUTE_SPAWN_OPER);
+		if (run->state == CUTE_OFF_STATE)
+			break;
+
+		if ((run->base->ops == &cute_thread_suite_ops) &&
+		    (cute_the_config->threads > 1))
+			cute_pool_enter(run, cute_the_config->threads);
+		else if (cute_the_config->snapshot && run->setup)
+			cute_pool_snapshot(run);
 		break;
 
 	case CUTE_END_VISIT:
-	case CUTE_ONCE_VISIT:
+		cute_pool_leave(run);
 		cute_run_oper(run, CUTE_COMPLETE_OPER);
 		break;
 
+	case CUTE_ONCE_VISIT:
+		cute_pool_complete(run);
+		break;
+
 	default:
 		__cute_unreachable();
 	}
@@ -302,8 +360,29 @@ cute_suite_run_tree(void)
 {
 	cute_assert_intern(cute_suite_root_run);
 
+	int err;
+
+	/* Must be opened before any process is spawned. */
+	err = cute_iodir_setup();
+	if (err)
+		return err;
+
+	cute_perf_init();
+
+	/* Must be spawned before any test is run. */
+	cute_bisect_init();
+
+	if (cute_the_config->jobs > 1)
+		cute_pool_init(cute_suite_root_run, cute_the_config->jobs);
+
 	cute_run_foreach(cute_suite_root_run, cute_suite_oper_tree_run, NULL);
 
+	cute_cache_store(cute_suite_root_run);
+	cute_cov_store(cute_suite_root_run);
+
+	cute_bisect_run(cute_suite_root_run);
+	cute_bisect_fini();
+
 	switch (cute_suite_root_run->issue) {
 	case CUTE_PASS_ISSUE:
 	case CUTE_SKIP_ISSUE:
@@ -312,6 +391,7 @@ cute_suite_run_tree(void)
 
 	case CUTE_FAIL_ISSUE:
 	case CUTE_EXCP_ISSUE:
+	case CUTE_CUT_ISSUE:
 		return -EPERM;
 
 	default:
@@ -319,47 +399,211 @@ cute_suite_run_tree(void)
 	}
 }
 
+/*
+ * Run tree materialization.
+ *
+ * Selection is evaluated against the static test hierarchy, building full names
+ * into a local buffer, and runs are created for selected nodes and their
+ * ancestors only. Subtrees that cannot hold any selected node are skipped
+ * altogether and only their test cases are counted so that reports may still
+ * give the total number of tests of the hierarchy.
+ */
+struct cute_suite_frame {
+	struct cute_iter         iter;
+	const struct cute_base * base;
+	struct cute_run *        run;
+	size_t                   len;
+	unsigned int             match;
+	unsigned int             tests;
+};
+
 static void
-cute_suite_init_tree_run(const struct cute_base * base,
-                         enum cute_visit          visit,
-                         void *                   data)
+cute_suite_count_tests_run(const struct cute_base * base __cute_unused,
+                           enum cute_visit          visit,
+                           void *                   data)
 {
 	cute_base_assert_intern(base);
 	cute_assert_intern(data);
-	cute_stack_assert_intern((struct cute_stack *)data);
-	cute_assert_intern(cute_stack_count((struct cute_stack *)data));
-	cute_assert_intern(cute_suite_root_run);
 
-	struct cute_stack * stk = (struct cute_stack *)data;
+	if (visit == CUTE_ONCE_VISIT)
+		(*(unsigned int *)data)++;
+}
 
-	switch (visit) {
-	case CUTE_BEGIN_VISIT:
-	case CUTE_ONCE_VISIT:
-		{
-			struct cute_run * run;
+static unsigned int
+cute_suite_count_tests(const struct cute_base * base)
+{
+	cute_base_assert_intern(base);
+
+	unsigned int cnt = 0;
+
+	if (base->ops == &cute_test_ops)
+		return 1;
+
+	cute_base_foreach(base, cute_suite_count_tests_run, &cnt);
+
+	return cnt;
+}
+
+static void
+cute_suite_set_tests(struct cute_run * run, unsigned int tests)
+{
+	cute_run_assert_intern(run);
+	cute_suite_assert_intern((const struct cute_suite *)run->base);
+
+	((struct cute_suite_run *)run)->tests = tests;
+}
+
+/*
+ * Create runs of the given stack of frames which are still missing, then the
+ * run of the selected node itself.
+ */
+static struct cute_run *
+cute_suite_create_tree_run(struct cute_suite_frame * frames,
+                           unsigned int              cnt,
+                           const struct cute_base *  base)
+{
+	cute_assert_intern(frames);
+	cute_assert_intern(cnt);
+	cute_assert_intern(frames[0].run);
+
+	unsigned int      f;
+	struct cute_run * run;
+
+	for (f = 1; f < cnt; f++) {
+		if (!frames[f].run)
+			frames[f].run = cute_create_run(frames[f].base,
+			                                frames[f - 1].run);
+	}
+
+	run = cute_create_run(base, frames[cnt - 1].run);
+	cute_run_turn_on(run);
+
+	return run;
+}
+
+static void
+cute_suite_build_tree(struct cute_run * root)
+{
+	cute_run_assert_intern(root);
+	cute_assert_intern(!root->parent);
+
+	struct cute_suite_frame frames[CUTE_DEPTH_MAX];
+	unsigned int            cnt = 1;
+	char                    name[CUTE_FULL_NAME_MAX_LEN + 1];
+	bool                    sub __cute_unused;
+
+	frames[0].base = root->base;
+	frames[0].run = root;
+	frames[0].len = strlen(root->name);
+	frames[0].match = cute_match_name(root->name, false, NULL);
+	frames[0].tests = 0;
+	memcpy(name, root->name, frames[0].len);
+
+	if (frames[0].match & CUTE_MATCH_SELECT)
+		cute_run_turn_on(root);
+	else if (frames[0].match & CUTE_MATCH_PRUNE) {
+		cute_suite_set_tests(root, cute_suite_count_tests(root->base));
+		return;
+	}
 
-			run = (struct cute_run *)cute_stack_peek(stk);
-			cute_run_assert_intern(run);
+	sub = cute_base_init_iter(root->base, &frames[0].iter);
+	cute_assert_intern(sub);
+
+	do {
+		struct cute_suite_frame * frame = &frames[cnt - 1];
+		const struct cute_base *  base;
+		bool                      test;
+		size_t                    blen;
+		unsigned int              match;
+		struct cute_run *         run = NULL;
+
+		if (cute_iter_end(&frame->iter)) {
+			if (frame->run)
+				cute_suite_set_tests(frame->run, frame->tests);
+			if (cnt > 1)
+				frames[cnt - 2].tests += frame->tests;
+			cnt--;
+			continue;
+		}
+
+		base = cute_iter_const_next(&frame->iter);
+		cute_base_assert_intern(base);
+		test = (base->ops == &cute_test_ops);
 
-			run = cute_create_run(base, run);
-			cute_run_assert_intern(run);
+		blen = strnlen(base->name, CUTE_NAME_MAX_LEN + 1);
+		cute_assert(blen <= CUTE_NAME_MAX_LEN);
+		cute_assert((frame->len + 2 + blen) <= CUTE_FULL_NAME_MAX_LEN);
 
-			if (visit == CUTE_BEGIN_VISIT)
-				cute_stack_push(stk, run);
+		name[frame->len] = ':';
+		name[frame->len + 1] = ':';
+		memcpy(&name[frame->len + 2], base->name, blen);
+		name[frame->len + 2 + blen] = '\0';
+
+		match = cute_match_name(name, test, &frame->match);
+		if (match & CUTE_MATCH_SELECT) {
+			run = cute_suite_create_tree_run(frames, cnt, base);
+			if (test && cute_cache_probe(run->name))
+				run->cached = true;
+		}
+		else if (match & CUTE_MATCH_PRUNE) {
+			frame->tests += cute_suite_count_tests(base);
+			continue;
 		}
-		break;
 
-	case CUTE_END_VISIT:
-		cute_stack_pop(stk);
-		break;
+		if (test) {
+			frame->tests++;
+			continue;
+		}
 
-	default:
-		__cute_unreachable();
+		cute_assert(cnt < CUTE_DEPTH_MAX);
+		frame = &frames[cnt++];
+		sub = cute_base_init_iter(base, &frame->iter);
+		cute_assert_intern(sub);
+		frame->base = base;
+		frame->run = run;
+		frame->len = frames[cnt - 2].len + 2 + blen;
+		frame->match = match;
+		frame->tests = 0;
+	} while (cnt);
+}
+
+/*
+ * Tell whether the hierarchy rooted at base holds a node which full name is
+ * name by walking down the path it denotes.
+ */
+static bool
+cute_suite_probe_name(const struct cute_base * base, const char * name)
+{
+	cute_base_assert_intern(base);
+	cute_assert_intern(name);
+
+	while (true) {
+		struct cute_iter iter;
+		size_t           len = strlen(base->name);
+
+		if (strncmp(name, base->name, len))
+			return false;
+		if (!name[len])
+			return true;
+		if ((name[len] != ':') || (name[len + 1] != ':'))
+			return false;
+		name += len + 2;
+
+		if (!cute_base_init_iter(base, &iter))
+			return false;
+
+		do {
+			if (cute_iter_end(&iter))
+				return false;
+			base = cute_iter_const_next(&iter);
+			len = strlen(base->name);
+		} while (strncmp(name, base->name, len) ||
+		         (name[len] && (name[len] != ':')));
 	}
 }
 
 static void
-cute_suite_enable_tree_run(struct cute_run * run,
+cute_suite_report_tree_run(struct cute_run * run,
                            enum cute_visit   visit,
                            void *            data __cute_unused)
 {
@@ -368,8 +612,6 @@ cute_suite_enable_tree_run(struct cute_run * run,
 	switch (visit) {
 	case CUTE_BEGIN_VISIT:
 	case CUTE_ONCE_VISIT:
-		if (cute_match_run(run))
-			cute_run_turn_on(run);
 		cute_run_report(run, CUTE_INIT_EVT);
 		break;
 
@@ -381,50 +623,52 @@ cute_suite_enable_tree_run(struct cute_run * run,
 	}
 }
 
-static int
-cute_suite_init_tree(const struct cute_suite * suite,
-                     const char *              pattern,
-                     bool                      icase)
+static uint64_t cute_suite_rand_state;
+
+/*
+ * SplitMix64 generator: tiny, fast and giving the same sequence on all
+ * platforms for a given seed, unlike rand(3).
+ */
+static unsigned int
+cute_suite_rand(unsigned int max)
 {
-	cute_suite_assert_intern(suite);
+	cute_assert_intern(max);
 
-	struct cute_stack  stk;
-	struct cute_run *  run;
-	struct cute_iter * iter;
-	int                err;
+	uint64_t z;
 
-	err = cute_match_init(pattern, icase);
-	if (err)
-		return err;
+	z = (cute_suite_rand_state += UINT64_C(0x9e3779b97f4a7c15));
+	z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+	z ^= z >> 31;
 
-	cute_stack_init(&stk);
+	return (unsigned int)(z % max);
+}
 
-	run = cute_create_run(&suite->super, NULL);
+static void
+cute_suite_shuffle_tree_run(struct cute_run * run,
+                            enum cute_visit   visit,
+                            void *            data __cute_unused)
+{
 	cute_run_assert_intern(run);
-	if (pattern)
-		run->state = CUTE_OFF_STATE;
 
-	cute_suite_root_run = run;
+	struct cute_suite_run * srun = (struct cute_suite_run *)run;
+	unsigned int            s;
 
-	cute_stack_push(&stk, run);
-	iter = cute_base_create_iter(&suite->super);
-	cute_iter_assert_intern(iter);
-	while (!cute_iter_end(iter)) {
-		const struct cute_base * child;
+	if (visit != CUTE_BEGIN_VISIT)
+		return;
 
-		child = cute_iter_const_next(iter);
-		cute_base_assert_intern(child);
+	/* Fisher-Yates shuffle of children. */
+	for (s = srun->count; s > 1; s--) {
+		unsigned int      r = cute_suite_rand(s);
+		struct cute_run * sub = srun->subs[s - 1];
 
-		cute_base_foreach(child, cute_suite_init_tree_run, &stk);
+		srun->subs[s - 1] = srun->subs[r];
+		srun->subs[r] = sub;
 	}
 
-	cute_iter_destroy(iter);
-
-	cute_stack_fini(&stk);
-
-	cute_run_foreach(run, cute_suite_enable_tree_run, NULL);
-
-	return 0;
+	/* Number children according to the order they are run into. */
+	for (s = 0; s < srun->count; s++)
+		srun->subs[s]->id = (int)s;
 }
 
 static void
@@ -457,11 +701,68 @@ cute_suite_fini_tree(void)
 		                 NULL);
 
 		cute_suite_root_run = NULL;
+
+		/* Release memory of all runs and their names at once. */
+		cute_run_release_tree();
 	}
 
+	cute_pool_fini();
+
 	cute_match_fini();
 }
 
+static int
+cute_suite_init_tree(const struct cute_suite * suite,
+                     const char *              pattern,
+                     bool                      icase)
+{
+	cute_suite_assert_intern(suite);
+
+	struct cute_run * run;
+	int               err;
+
+	if (cute_the_config->name &&
+	    !cute_suite_probe_name(&suite->super, cute_the_config->name)) {
+		cute_error("'%s': no such test or suite.\n",
+		           cute_the_config->name);
+		return -ENOENT;
+	}
+
+	err = cute_match_init(pattern, icase);
+	if (err)
+		return err;
+
+	run = cute_create_run(&suite->super, NULL);
+	cute_run_assert_intern(run);
+	if (pattern ||
+	    cute_the_config->name ||
+	    cute_the_config->includes ||
+	    cute_the_config->excludes ||
+	    (cute_the_config->shards > 1) ||
+	    cute_the_config->rerun_path)
+		run->state = CUTE_OFF_STATE;
+
+	cute_suite_root_run = run;
+
+	cute_suite_build_tree(run);
+
+	cute_run_index_tree(run);
+
+	if (cute_the_config->shuffle) {
+		cute_suite_rand_state = cute_the_config->seed;
+		cute_run_foreach(run, cute_suite_shuffle_tree_run, NULL);
+		cute_run_index_tree(run);
+	}
+
+	cute_run_foreach(run, cute_suite_report_tree_run, NULL);
+
+	return 0;
+}
+
+/*
+ * Build runs of the requested node, its ancestors and descendants only, the
+ * same way -N option does, regardless of selectors given at running time.
+ */
 int
 cute_suite_info(const struct cute_suite * suite, const char * name)
 {
@@ -469,29 +770,39 @@ cute_suite_info(const struct cute_suite * suite, const char * name)
 	cute_config_assert(cute_the_config);
 	cute_assert_intern(!name || name[0]);
 
+	struct cute_config *    conf = cute_the_config;
+	struct cute_config      info = *conf;
 	const struct cute_run * run;
-	int                     ret = 0;
+	int                     ret;
 
-	cute_suite_init_tree(suite, NULL, false);
+	info.name = name;
+	info.includes = NULL;
+	info.excludes = NULL;
+	info.shards = 1;
+	info.shard = 0;
+	info.rerun_path = NULL;
+	info.shuffle = false;
 
-	if (name) {
-		cute_assert_intern(name[0]);
+	cute_the_config = &info;
 
+	ret = cute_suite_init_tree(suite, NULL, false);
+	if (ret)
+		goto restore;
+
+	run = cute_suite_root_run;
+	if (name && strcmp(name, run->name)) {
+		/* Name has been resolved by cute_suite_init_tree(). */
 		run = cute_run_find(cute_suite_root_run, name);
-		if (!run) {
-			cute_error("'%s': no such test or suite.\n", name);
-			ret = -ENOENT;
-			goto fini;
-		}
+		cute_assert_intern(run);
 	}
-	else
-		run = cute_suite_root_run;
 
 	cute_run_report(run, CUTE_INFO_EVT);
 
-fini:
 	cute_suite_fini_tree();
 
+restore:
+	cute_the_config = conf;
+
 	return ret;
 }
 
@@ -14,6 +14,7 @@ struct cute_suite_run {
 	struct cute_run   super;
 	struct cute_stats stats;
 	struct cute_stats sums;
+	unsigned int      tests;
 	unsigned int      count;
 	struct cute_run * subs[];
 };
@@ -7,6 +7,8 @@
 
 #include "cons.h"
 #include "suite.h"
+#include "bisect.h"
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
@@ -80,13 +82,11 @@ cute_tap_report_stdio(FILE *                  stdio,
 }
 
 static void
-cute_tap_report_realize_details(FILE *                  stdio,
-                                int                     depth,
-                                const struct cute_run * run)
+cute_tap_report_span(FILE *                   stdio,
+                     int                      depth,
+                     const char *             label,
+                     const struct cute_span * span)
 {
-	cute_assert_intern(stdio);
-	cute_assert_intern(run);
-
 	struct timespec diff;
 	ldiv_t          elapse;
 
@@ -94,13 +94,97 @@ cute_tap_report_realize_details(FILE *                  stdio,
 	 * milliseconds: (diff.tv_sec * 1000L) + (diff.tv_nsec / 1000000L)
 	 * nanoseconds:  diff.tv_nsec % 1000000L
 	 */
-	cute_diff_tspec(&diff, &run->begin, &run->end);
+	cute_span_diff(&diff, span);
 	elapse = ldiv(diff.tv_nsec, 1000000L);
 
 	fprintf(stdio,
-	        "%2$*1$s  duration_ms: %3$ld.%4$06ld\n"
-	        "%2$*1$s  ...\n",
-	        depth, "", (diff.tv_sec * 1000L) + elapse.quot, elapse.rem);
+	        "%2$*1$s  %3$s: %4$ld.%5$06ld\n",
+	        depth, "",
+	        label,
+	        (diff.tv_sec * 1000L) + elapse.quot, elapse.rem);
+}
+
+static void
+cute_tap_report_usage(FILE *                    stdio,
+                      int                       depth,
+                      const struct cute_usage * usage)
+{
+	fprintf(stdio,
+	        "%2$*1$s  user_ms: %3$ld.%4$03ld\n"
+	        "%2$*1$s  system_ms: %5$ld.%6$03ld\n"
+	        "%2$*1$s  minor_faults: %7$ld\n"
+	        "%2$*1$s  major_faults: %8$ld\n"
+	        "%2$*1$s  voluntary_switches: %9$ld\n"
+	        "%2$*1$s  involuntary_switches: %10$ld\n"
+	        "%2$*1$s  maxrss_growth_kb: %11$ld\n",
+	        depth, "",
+	        usage->utime / 1000L, usage->utime % 1000L,
+	        usage->stime / 1000L, usage->stime % 1000L,
+	        usage->minflt,
+	        usage->majflt,
+	        usage->nvcsw,
+	        usage->nivcsw,
+	        usage->maxrss);
+}
+
+static void
+cute_tap_report_perf(FILE *                   stdio,
+                     int                      depth,
+                     const struct cute_perf * perf)
+{
+	unsigned int c;
+
+	if (!perf->mask)
+		return;
+
+	fprintf(stdio, "%*s  perf:\n", depth, "");
+	for (c = 0; c < CUTE_PERF_NR; c++) {
+		if (perf->mask & (1U << c))
+			fprintf(stdio,
+			        "%*s    %s: %" PRIu64 "\n",
+			        depth, "",
+			        cute_perf_name(c),
+			        perf->counts[c]);
+	}
+}
+
+static void
+cute_tap_report_heap(FILE *                   stdio,
+                     int                      depth,
+                     const struct cute_heap * heap)
+{
+	if (!heap->tracked)
+		return;
+
+	fprintf(stdio,
+	        "%2$*1$s  heap:\n"
+	        "%2$*1$s    allocations: %3$lu\n"
+	        "%2$*1$s    bytes: %4$lu\n"
+	        "%2$*1$s    peak_bytes: %5$lu\n"
+	        "%2$*1$s    leaked_blocks: %6$lu\n",
+	        depth, "",
+	        heap->allocs,
+	        heap->bytes,
+	        heap->peak,
+	        heap->leaks);
+}
+
+static void
+cute_tap_report_realize_details(FILE *                  stdio,
+                                int                     depth,
+                                const struct cute_run * run)
+{
+	cute_assert_intern(stdio);
+	cute_assert_intern(run);
+
+	cute_tap_report_span(stdio, depth, "setup_ms", &run->times.setup);
+	cute_tap_report_span(stdio, depth, "duration_ms", &run->times.exec);
+	cute_tap_report_span(stdio, depth, "teardown_ms", &run->times.teardown);
+	cute_tap_report_usage(stdio, depth, &run->usage);
+	cute_tap_report_perf(stdio, depth, &run->perf);
+	cute_tap_report_heap(stdio, depth, &run->heap);
+
+	fprintf(stdio, "%*s  ...\n", depth, "");
 }
 
 static void
@@ -162,6 +246,15 @@ cute_tap_report_test_done(const struct cute_tap_report * report,
 
 	switch (run->issue) {
 	case CUTE_PASS_ISSUE:
+		if (run->cached) {
+			fprintf(report->stdio,
+			        "%*sok %d - %s # cached\n",
+			        depth, "",
+			        run->id + 1,
+			        run->base->name);
+			break;
+		}
+
 		fprintf(report->stdio,
 		        "%2$*1$sok %3$d - %4$s\n"
 		        "%2$*1$s  ---\n",
@@ -196,6 +289,14 @@ cute_tap_report_test_done(const struct cute_tap_report * report,
 		        run->base->name);
 		break;
 
+	case CUTE_CUT_ISSUE:
+		fprintf(report->stdio,
+		        "%*sok %d - %s # SKIP cut short\n",
+		        depth, "",
+		        run->id + 1,
+		        run->base->name);
+		break;
+
 	default:
 		__cute_unreachable();
 	}
@@ -229,6 +330,11 @@ static void
 cute_tap_report_on_head(struct cute_tap_report * report)
 {
 	fprintf(report->stdio, "TAP version 14\n");
+
+	if (cute_the_config->shuffle)
+		fprintf(report->stdio,
+		        "# random order seed: %u\n",
+		        cute_the_config->seed);
 }
 
 static void
@@ -244,10 +350,27 @@ cute_tap_report_suite_setup(const struct cute_tap_report * report,
 		        depth,
 		        "",
 		        suite->super.base->name,
-		        suite->stats.total);
+		        suite->count);
 	}
 	else
-		fprintf(report->stdio, "1..%u\n", suite->stats.total);
+		fprintf(report->stdio, "1..%u\n", suite->count);
+}
+
+static void
+cute_tap_report_on_foot(const struct cute_tap_report * report,
+                        const struct cute_suite_run *  suite)
+{
+	if (cute_bisect_victim)
+		fprintf(report->stdio,
+		        "# order dependency: %s fails when run after %s\n",
+		        cute_bisect_victim->name,
+		        cute_bisect_culprit->name);
+
+	if (suite->sums.cut)
+		fprintf(report->stdio,
+		        "Bail out! %u failure(s), %u test(s) not run\n",
+		        suite->sums.fail + suite->sums.excp,
+		        suite->sums.cut);
 }
 
 static void
@@ -270,11 +393,14 @@ cute_tap_report_suite(struct cute_tap_report *       report,
 			cute_tap_report_test_done(report, &suite->super);
 		break;
 
+	case CUTE_FOOT_EVT:
+		cute_tap_report_on_foot(report, suite);
+		break;
+
 	case CUTE_INIT_EVT:
 	case CUTE_EXEC_EVT:
 	case CUTE_TEARDOWN_EVT:
 	case CUTE_FINI_EVT:
-	case CUTE_FOOT_EVT:
 	case CUTE_INFO_EVT:
 	case CUTE_SHOW_EVT:
 		break;
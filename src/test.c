@@ -7,7 +7,11 @@
 
 #include "run.h"
 #include "report.h"
+#include "leak.h"
+#include "cov.h"
+#include <stdlib.h>
 #include <unistd.h>
+#include <sys/resource.h>
 
 #define cute_test_assert(_test) \
 	cute_base_assert(&(_test)->super); \
@@ -34,14 +38,51 @@ cute_test_report(const struct cute_run * run, enum cute_event event)
 	cute_report_test(event, run);
 }
 
-static struct cute_iter *
-cute_test_run_iter(struct cute_run * run __cute_unused)
+static bool
+cute_test_run_iter(struct cute_run *  run __cute_unused,
+                   struct cute_iter * iter __cute_unused)
 {
 	cute_run_assert_intern(run);
 	cute_test_assert_intern((const struct cute_test *)run->base);
+	cute_assert_intern(iter);
 
-	errno = ENOENT;
-	return NULL;
+	return false;
+}
+
+static void
+cute_test_load_usage(struct cute_usage * usage)
+{
+	struct rusage ru;
+	int           err __cute_unused;
+
+	/* Tests of threaded suites may run concurrently: sample own thread. */
+	err = getrusage(RUSAGE_THREAD, &ru);
+	cute_assert_intern(!err);
+
+	usage->utime = (ru.ru_utime.tv_sec * 1000000L) + ru.ru_utime.tv_usec;
+	usage->stime = (ru.ru_stime.tv_sec * 1000000L) + ru.ru_stime.tv_usec;
+	usage->minflt = ru.ru_minflt;
+	usage->majflt = ru.ru_majflt;
+	usage->nvcsw = ru.ru_nvcsw;
+	usage->nivcsw = ru.ru_nivcsw;
+	usage->maxrss = ru.ru_maxrss;
+}
+
+/* Turn usage sampled before running a test into consumed resources. */
+static void
+cute_test_diff_usage(struct cute_usage * usage)
+{
+	struct cute_usage now;
+
+	cute_test_load_usage(&now);
+
+	usage->utime = now.utime - usage->utime;
+	usage->stime = now.stime - usage->stime;
+	usage->minflt = now.minflt - usage->minflt;
+	usage->majflt = now.majflt - usage->majflt;
+	usage->nvcsw = now.nvcsw - usage->nvcsw;
+	usage->nivcsw = now.nivcsw - usage->nivcsw;
+	usage->maxrss = now.maxrss - usage->maxrss;
 }
 
 static void
@@ -59,10 +100,14 @@ cute_test_exec_run(struct cute_run * run, const struct cute_test * test)
 	run->state = CUTE_EXEC_STATE;
 
 	cute_run_settle(run);
+	cute_perf_open();
 
 	issue = sigsetjmp(cute_jmp_env, 1);
 	if (!issue) {
-		cute_gettime(&run->begin);
+		cute_test_load_usage(&run->usage);
+		cute_gettime(&run->times.exec.begin);
+		cute_perf_start();
+		cute_heap_resume();
 		test->exec();
 		goto out;
 	}
@@ -73,7 +118,10 @@ cute_test_exec_run(struct cute_run * run, const struct cute_test * test)
 	run->issue = issue;
 
 out:
-	cute_gettime(&run->end);
+	cute_perf_stop(&run->perf);
+	cute_heap_suspend();
+	cute_gettime(&run->times.exec.end);
+	cute_test_diff_usage(&run->usage);
 	cute_run_unsettle(run);
 
 	cute_run_report(run, CUTE_EXEC_EVT);
@@ -97,7 +145,22 @@ cute_test_setup(struct cute_run * run)
 		goto report;
 	}
 
+	if (run->cached) {
+		/* Passed by a previous run of the very same build. */
+		run->issue = CUTE_PASS_ISSUE;
+		goto report;
+	}
+
+	if (cute_run_cut()) {
+		run->issue = CUTE_CUT_ISSUE;
+		goto report;
+	}
+
 	run->state = CUTE_SETUP_STATE;
+	cute_getstamp(&run->stamp);
+	cute_leak_start();
+	cute_heap_start();
+	cute_cov_start();
 	if (!run->setup) {
 		ret = 0;
 		goto report;
@@ -107,6 +170,8 @@ cute_test_setup(struct cute_run * run)
 
 	issue = sigsetjmp(cute_jmp_env, 1);
 	if (!issue) {
+		cute_gettime(&run->times.setup.begin);
+		cute_heap_resume();
 		run->setup();
 		ret = 0;
 		goto unsettle;
@@ -118,6 +183,8 @@ cute_test_setup(struct cute_run * run)
 	run->issue = issue;
 
 unsettle:
+	cute_heap_suspend();
+	cute_gettime(&run->times.setup.end);
 	cute_run_unsettle(run);
 report:
 	cute_run_report(run, CUTE_SETUP_EVT);
@@ -145,6 +212,8 @@ cute_test_teardown(struct cute_run * run)
 
 	issue = sigsetjmp(cute_jmp_env, 1);
 	if (!issue) {
+		cute_gettime(&run->times.teardown.begin);
+		cute_heap_resume();
 		run->teardown();
 		goto unsettle;
 	}
@@ -154,11 +223,152 @@ cute_test_teardown(struct cute_run * run)
 	run->issue = issue;
 
 unsettle:
+	cute_heap_suspend();
+	cute_gettime(&run->times.teardown.end);
 	cute_run_unsettle(run);
 report:
 	cute_run_report(run, CUTE_TEARDOWN_EVT);
 }
 
+static void
+cute_test_complete_run(struct cute_run * run)
+{
+	if (cute_test_setup(run))
+		goto done;
+
+	cute_test_exec_run(run, (const struct cute_test *)run->base);
+
+	cute_test_teardown(run);
+
+done:
+	cute_cov_stop(run);
+	cute_heap_stop(&run->heap);
+	run->leaks = cute_leak_stop();
+	cute_run_done(run);
+}
+
+static void
+cute_test_release_run(struct cute_run * run)
+{
+	cute_iodir_fini_block(&run->ioout);
+	cute_iodir_fini_block(&run->ioerr);
+	cute_assess_release(&run->assess);
+}
+
+static int
+cute_test_cmp_usec(const void * first, const void * second)
+{
+	unsigned long fst = *(const unsigned long *)first;
+	unsigned long snd = *(const unsigned long *)second;
+
+	return (fst > snd) - (fst < snd);
+}
+
+/*
+ * Run test cute_config::repeat times, possibly stopping at first failure when
+ * cute_config::until_fail is set.
+ *
+ * Each iteration is run onto a scratch copy of the initial run given its own
+ * output capture blocks. Outcome of first failed iteration, or the last one
+ * when none failed, is kept into run and reported once all iterations have
+ * completed, along with pass / fail counts and duration distribution.
+ */
+static void
+cute_test_repeat_run(struct cute_run * run)
+{
+	cute_config_assert_intern(cute_the_config);
+	cute_assert_intern(cute_the_config->repeat > 1);
+
+	const struct cute_run tmpl = *run;
+	unsigned int          nr = cute_the_config->repeat;
+	unsigned long *       usecs;
+	unsigned int          events = 0;
+	struct cute_repeat    rep = { 0, };
+	bool                  kept = false;
+
+	usecs = cute_malloc(nr * sizeof(usecs[0]));
+
+	while (rep.runs < nr) {
+		struct cute_run scratch = tmpl;
+		unsigned int    evts = 0;
+		unsigned int *  prev;
+		struct timespec diff;
+		bool            last;
+
+		cute_iodir_init_block(&scratch.ioout);
+		cute_iodir_init_block(&scratch.ioerr);
+
+		prev = cute_report_divert(&evts);
+		cute_curr_run = &scratch;
+		cute_test_complete_run(&scratch);
+		cute_curr_run = run;
+		cute_report_divert(prev);
+
+		if (scratch.issue == CUTE_CUT_ISSUE) {
+			/* Run cut short by another failed test. */
+			if (kept) {
+				cute_test_release_run(&scratch);
+				break;
+			}
+			last = true;
+			goto keep;
+		}
+
+		cute_span_diff(&diff, &scratch.times.exec);
+		usecs[rep.runs++] = ((unsigned long)diff.tv_sec * 1000000UL) +
+		                    ((unsigned long)diff.tv_nsec / 1000UL);
+
+		switch (scratch.issue) {
+		case CUTE_PASS_ISSUE:
+			rep.pass++;
+			last = false;
+			break;
+
+		case CUTE_FAIL_ISSUE:
+		case CUTE_EXCP_ISSUE:
+			rep.fail++;
+			last = cute_the_config->until_fail;
+			break;
+
+		default:
+			last = false;
+			break;
+		}
+
+		last = last || (rep.runs == nr);
+		if (!kept && (last || rep.fail))
+			goto keep;
+
+		cute_test_release_run(&scratch);
+
+		if (last)
+			break;
+		continue;
+
+keep:
+		/* Only initial capture blocks are owned by run at this time. */
+		cute_test_release_run(run);
+		*run = scratch;
+		events = evts;
+		kept = true;
+		if (last)
+			break;
+	}
+
+	if (rep.runs) {
+		qsort(usecs, rep.runs, sizeof(usecs[0]), cute_test_cmp_usec);
+		rep.min = usecs[0];
+		rep.med = usecs[(rep.runs - 1) / 2];
+		rep.p95 = usecs[(((95 * rep.runs) + 99) / 100) - 1];
+		rep.max = usecs[rep.runs - 1];
+	}
+
+	cute_free(usecs);
+
+	run->repeat = rep;
+	cute_run_replay(run, events);
+}
+
 static void
 cute_test_oper_run(struct cute_run * run, enum cute_oper oper __cute_unused)
 {
@@ -171,15 +381,14 @@ cute_test_oper_run(struct cute_run * run, enum cute_oper oper __cute_unused)
 	cute_assert_intern(!run->why);
 	cute_assert_intern(oper == CUTE_COMPLETE_OPER);
 
-	if (cute_test_setup(run))
-		goto done;
-
-	cute_test_exec_run(run, (const struct cute_test *)run->base);
-
-	cute_test_teardown(run);
+	if ((cute_the_config->repeat > 1) &&
+	    (run->state != CUTE_OFF_STATE) &&
+	    !run->cached)
+		cute_test_repeat_run(run);
+	else
+		cute_test_complete_run(run);
 
-done:
-	cute_run_done(run);
+	cute_run_tally(run);
 }
 
 static void
@@ -197,7 +406,13 @@ cute_test_sum_run(const struct cute_run * run, struct cute_stats * sums)
 	case CUTE_OFF_ISSUE:
 		return;
 
+	case CUTE_CUT_ISSUE:
+		sums->cut++;
+		return;
+
 	case CUTE_PASS_ISSUE:
+		if (run->cached)
+			sums->cached++;
 		sums->pass++;
 		break;
 
@@ -229,13 +444,14 @@ static const struct cute_run_ops cute_test_run_ops = {
 	.fini   = cute_run_dummy_fini
 };
 
-static struct cute_iter *
-cute_test_iter(const struct cute_base * test __cute_unused)
+static bool
+cute_test_iter(const struct cute_base * test __cute_unused,
+               struct cute_iter *       iter __cute_unused)
 {
 	cute_test_assert_intern((const struct cute_test *)test);
+	cute_assert_intern(iter);
 
-	errno = ENOENT;
-	return NULL;
+	return false;
 }
 
 static struct cute_run *
@@ -245,7 +461,7 @@ cute_test_run(const struct cute_base * test, struct cute_run * parent)
 
 	struct cute_run * run;
 
-	run = cute_malloc(sizeof(*run));
+	run = cute_run_alloc(sizeof(*run));
 	cute_run_init(run, &cute_test_run_ops, test, parent);
 
 	return run;
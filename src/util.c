@@ -7,9 +7,11 @@
 
 #include "common.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <ctype.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 void
 cute_fail_assert(const char * message,
@@ -64,6 +66,122 @@ log:
 	return -err;
 }
 
+/*
+ * Load whole content of file located at path into a NUL terminated buffer to
+ * be released using cute_free().
+ */
+int
+cute_load_file(const char * path, char ** data, size_t * size)
+{
+	cute_assert_intern(path);
+	cute_assert_intern(path[0]);
+	cute_assert_intern(data);
+	cute_assert_intern(size);
+
+	int         fd;
+	struct stat st;
+	char *      buff;
+	size_t      len = 0;
+	int         err;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -errno;
+
+	if (fstat(fd, &st)) {
+		err = -errno;
+		goto close;
+	}
+
+	buff = cute_malloc((size_t)st.st_size + 1);
+	while (len < (size_t)st.st_size) {
+		ssize_t ret;
+
+		ret = read(fd, &buff[len], (size_t)st.st_size - len);
+		if (ret > 0) {
+			len += (size_t)ret;
+			continue;
+		}
+		else if (!ret)
+			break;
+		else if (errno == EINTR)
+			continue;
+
+		err = -errno;
+		goto free;
+	}
+
+	close(fd);
+
+	buff[len] = '\0';
+	*data = buff;
+	*size = len;
+
+	return 0;
+
+free:
+	cute_free(buff);
+close:
+	close(fd);
+
+	return err;
+}
+
+/*
+ * Write content generated by store to a temporary file renamed over the one
+ * located at path so that readers never load a partially written file.
+ */
+int
+cute_store_file(const char * path, cute_store_fn * store, void * data)
+{
+	cute_assert_intern(path);
+	cute_assert_intern(path[0]);
+	cute_assert_intern(store);
+
+	char * tmp;
+	int    fd;
+	FILE * stdio;
+	int    err;
+
+	tmp = cute_malloc(strlen(path) + sizeof(".XXXXXX"));
+	sprintf(tmp, "%s.XXXXXX", path);
+
+	fd = mkostemp(tmp, O_CLOEXEC);
+	if (fd < 0) {
+		err = -errno;
+		goto free;
+	}
+
+	stdio = fdopen(fd, "w");
+	if (!stdio) {
+		err = -errno;
+		close(fd);
+		goto unlink;
+	}
+
+	store(stdio, data);
+
+	err = cute_close_stdio(stdio);
+	if (err)
+		goto unlink;
+
+	if (rename(tmp, path)) {
+		err = -errno;
+		goto unlink;
+	}
+
+	cute_free(tmp);
+
+	return 0;
+
+unlink:
+	unlink(tmp);
+free:
+	cute_free(tmp);
+
+	return err;
+}
+
 /******************************************************************************
  * Memory allocation wrapping.
  ******************************************************************************/
@@ -103,6 +221,93 @@ cute_free(void * ptr)
 	__libc_free(ptr);
 }
 
+/******************************************************************************
+ * Bump pointer arena allocator
+ ******************************************************************************/
+
+struct cute_arena_chunk {
+	struct cute_arena_chunk * next;
+	max_align_t               data[];
+};
+
+#define CUTE_ARENA_CHUNK_SIZE (64U * 1024U)
+
+#define CUTE_ARENA_ALIGN      (sizeof(max_align_t))
+
+static struct cute_arena_chunk *
+cute_arena_alloc_chunk(size_t size)
+{
+	cute_assert_intern(size);
+
+	return cute_malloc(sizeof(struct cute_arena_chunk) + size);
+}
+
+void *
+cute_arena_alloc(struct cute_arena * arena, size_t size)
+{
+	cute_assert_intern(arena);
+	cute_assert_intern(size);
+
+	char * ptr;
+
+	size = (size + CUTE_ARENA_ALIGN - 1) & ~(CUTE_ARENA_ALIGN - 1);
+
+	if (size > (CUTE_ARENA_CHUNK_SIZE / 4)) {
+		struct cute_arena_chunk * chunk;
+
+		/*
+		 * Give large allocations a chunk of their own so that space
+		 * left into the current chunk is not wasted.
+		 */
+		chunk = cute_arena_alloc_chunk(size);
+		if (arena->chunks) {
+			chunk->next = arena->chunks->next;
+			arena->chunks->next = chunk;
+		}
+		else {
+			chunk->next = NULL;
+			arena->chunks = chunk;
+		}
+
+		return chunk->data;
+	}
+
+	if (size > arena->left) {
+		struct cute_arena_chunk * chunk;
+
+		chunk = cute_arena_alloc_chunk(CUTE_ARENA_CHUNK_SIZE);
+		chunk->next = arena->chunks;
+		arena->chunks = chunk;
+		arena->free = (char *)chunk->data;
+		arena->left = CUTE_ARENA_CHUNK_SIZE;
+	}
+
+	ptr = arena->free;
+	arena->free += size;
+	arena->left -= size;
+
+	return ptr;
+}
+
+void
+cute_arena_release(struct cute_arena * arena)
+{
+	cute_assert_intern(arena);
+
+	struct cute_arena_chunk * chunk = arena->chunks;
+
+	while (chunk) {
+		struct cute_arena_chunk * next = chunk->next;
+
+		cute_free(chunk);
+		chunk = next;
+	}
+
+	arena->chunks = NULL;
+	arena->free = NULL;
+	arena->left = 0;
+}
+
 /******************************************************************************
  * System primitive wrappers
  ******************************************************************************/
@@ -365,59 +570,6 @@ cute_time_string(char                    string[CUTE_TIME_STRING_SZ],
 	return NULL;
 }
 
-/******************************************************************************
- * NULL terminated pointer array iterator handling
- ******************************************************************************/
-
-static struct cute_iter *
-cute_iter_alloc(unsigned int nr)
-{
-	cute_assert_intern(nr);
-
-	struct cute_iter * iter;
-
-	iter = cute_malloc(sizeof(*iter));
-
-	iter->next = 0;
-	iter->nr = nr;
-
-	return iter;
-}
-
-struct cute_iter *
-cute_iter_create(void * const * items, unsigned int nr, void * data)
-{
-	cute_assert_intern(items);
-	cute_assert_intern(nr);
-
-	struct cute_iter * iter;
-
-	iter = cute_iter_alloc(nr);
-
-	iter->rwitems = items;
-	iter->rwdata = data;
-
-	return iter;
-}
-
-struct cute_iter *
-cute_iter_const_create(const void * const * items,
-                       unsigned int         nr,
-                       const void *         data)
-{
-	cute_assert_intern(items);
-	cute_assert_intern(nr);
-
-	struct cute_iter * iter;
-
-	iter = cute_iter_alloc(nr);
-
-	iter->roitems = items;
-	iter->rodata = data;
-
-	return iter;
-}
-
 /******************************************************************************
  * Pointer based stack / LIFO handling
  ******************************************************************************/
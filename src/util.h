@@ -60,6 +60,14 @@ cute_fail_assert(const char * message,
 extern int
 cute_close_stdio(FILE * stdio);
 
+extern int
+cute_load_file(const char * path, char ** data, size_t * size);
+
+typedef void (cute_store_fn)(FILE * stdio, void * data);
+
+extern int
+cute_store_file(const char * path, cute_store_fn * store, void * data);
+
 /******************************************************************************
  * Memory allocation wrappers
  ******************************************************************************/
@@ -73,6 +81,30 @@ cute_realloc(void * ptr, size_t size);
 extern void
 cute_free(void * ptr);
 
+/******************************************************************************
+ * Bump pointer arena allocator
+ *
+ * Allocations are carved out of large chunks and cannot be freed
+ * individually: all of them are released at once by cute_arena_release().
+ ******************************************************************************/
+
+struct cute_arena_chunk;
+
+struct cute_arena {
+	struct cute_arena_chunk * chunks;
+	char *                    free;
+	size_t                    left;
+};
+
+#define CUTE_ARENA_INIT \
+	{ .chunks = NULL, .free = NULL, .left = 0 }
+
+extern void *
+cute_arena_alloc(struct cute_arena * arena, size_t size);
+
+extern void
+cute_arena_release(struct cute_arena * arena);
+
 /******************************************************************************
  * System primitive wrappers
  ******************************************************************************/
@@ -305,6 +337,11 @@ cute_regex_fini(regex_t * regex);
  * Timestamps handling.
  ******************************************************************************/
 
+/*
+ * Durations are computed out of the monotonic clock so that they are not
+ * affected by system time adjustments (see clock_gettime(2)).
+ * Wall clock is only used to timestamp reports.
+ */
 #if defined(CONFIG_CUTE_INTERN_ASSERT)
 
 static inline void
@@ -312,6 +349,14 @@ cute_gettime(struct timespec * tspec)
 {
 	cute_assert_intern(tspec);
 
+	cute_assert_intern(!clock_gettime(CLOCK_MONOTONIC, tspec));
+}
+
+static inline void
+cute_getstamp(struct timespec * tspec)
+{
+	cute_assert_intern(tspec);
+
 	cute_assert_intern(!clock_gettime(CLOCK_REALTIME, tspec));
 }
 
@@ -319,6 +364,12 @@ cute_gettime(struct timespec * tspec)
 
 static inline void
 cute_gettime(struct timespec * tspec)
+{
+	clock_gettime(CLOCK_MONOTONIC, tspec);
+}
+
+static inline void
+cute_getstamp(struct timespec * tspec)
 {
 	clock_gettime(CLOCK_REALTIME, tspec);
 }
@@ -412,20 +463,36 @@ cute_iter_next(struct cute_iter * iter)
 	return iter->rwitems[iter->next++];
 }
 
-extern struct cute_iter *
-cute_iter_create(void * const * items, unsigned int nr, void * data);
-
-extern struct cute_iter *
-cute_iter_const_create(const void * const * items,
-                       unsigned int         nr,
-                       const void *         data);
-
 static inline void
-cute_iter_destroy(struct cute_iter * iter)
+cute_iter_init(struct cute_iter * iter,
+               void * const *     items,
+               unsigned int       nr,
+               void *             data)
 {
-	cute_iter_assert_intern(iter);
+	cute_assert_intern(iter);
+	cute_assert_intern(items);
+	cute_assert_intern(nr);
+
+	iter->next = 0;
+	iter->nr = nr;
+	iter->rwitems = items;
+	iter->rwdata = data;
+}
 
-	cute_free(iter);
+static inline void
+cute_iter_const_init(struct cute_iter *   iter,
+                     const void * const * items,
+                     unsigned int         nr,
+                     const void *         data)
+{
+	cute_assert_intern(iter);
+	cute_assert_intern(items);
+	cute_assert_intern(nr);
+
+	iter->next = 0;
+	iter->nr = nr;
+	iter->roitems = items;
+	iter->rodata = data;
 }
 
 /******************************************************************************
@@ -45,6 +45,77 @@ cute_verb_report_test_setup(const struct cute_cons_report * report,
 	fflush(report->stdio);
 }
 
+/*
+ * Give time spent into each phase of tests that went through setup with
+ * nanosecond precision, and resources consumed by their test function.
+ */
+static void
+cute_verb_report_test_phases(const struct cute_cons_report * report,
+                             const struct cute_run *         run)
+{
+	struct timespec setup;
+	struct timespec exec;
+	struct timespec teardown;
+
+	switch (run->issue) {
+	case CUTE_PASS_ISSUE:
+		if (run->cached)
+			return;
+		break;
+
+	case CUTE_SKIP_ISSUE:
+	case CUTE_FAIL_ISSUE:
+	case CUTE_EXCP_ISSUE:
+		break;
+
+	default:
+		return;
+	}
+
+	cute_span_diff(&setup, &run->times.setup);
+	cute_span_diff(&exec, &run->times.exec);
+	cute_span_diff(&teardown, &run->times.teardown);
+
+	fprintf(report->stdio,
+	        "%s"
+	        "phases: setup %ld.%09lds, "
+	        "exec %ld.%09lds, "
+	        "teardown %ld.%09lds\n"
+	        "%s",
+	        report->term.gray,
+	        setup.tv_sec, setup.tv_nsec,
+	        exec.tv_sec, exec.tv_nsec,
+	        teardown.tv_sec, teardown.tv_nsec,
+	        report->term.regular);
+
+	fprintf(report->stdio,
+	        "%s"
+	        "usage:  user %ld.%06lds, system %ld.%06lds, maxrss +%ldkB\n"
+	        "events: %ld minor / %ld major faults, "
+	        "%ld voluntary / %ld involuntary switches\n"
+	        "%s",
+	        report->term.gray,
+	        run->usage.utime / 1000000L, run->usage.utime % 1000000L,
+	        run->usage.stime / 1000000L, run->usage.stime % 1000000L,
+	        run->usage.maxrss,
+	        run->usage.minflt, run->usage.majflt,
+	        run->usage.nvcsw, run->usage.nivcsw,
+	        report->term.regular);
+
+	if (run->heap.tracked)
+		fprintf(report->stdio,
+		        "%s"
+		        "heap:   %lu allocations, %lu bytes, peak %lu bytes, "
+		        "%lu leaked blocks\n"
+		        "%s",
+		        report->term.gray,
+		        run->heap.allocs,
+		        run->heap.bytes,
+		        run->heap.peak,
+		        run->heap.leaks,
+		        report->term.regular);
+}
+
 static void
 cute_verb_report_test_done(struct cute_cons_report * report,
                            const struct cute_run *   run)
@@ -52,7 +123,7 @@ cute_verb_report_test_done(struct cute_cons_report * report,
 	struct timespec diff;
 	sigset_t        set;
 
-	cute_diff_tspec(&diff, &run->begin, &run->end);
+	cute_span_diff(&diff, &run->times.exec);
 
 	fprintf(report->stdio,
 	        CUTE_CONS_REPORT_TIME_FMT " ",
@@ -60,6 +131,7 @@ cute_verb_report_test_done(struct cute_cons_report * report,
 
 	cute_cons_report_mask(report, &set);
 	cute_cons_report_test_done(report, run);
+	cute_verb_report_test_phases(report, run);
 	cute_cons_report_unmask(report, &set);
 }
 
@@ -193,7 +265,7 @@ cute_verb_report_suite_done(const struct cute_cons_report * report,
 		                       (1 + CUTE_CONS_REPORT_STAT_WIDTH);
 		struct timespec diff;
 
-		cute_diff_tspec(&diff, &suite->super.begin, &suite->super.end);
+		cute_span_diff(&diff, &suite->super.times.exec);
 
 		cute_cons_report_mask(report, &set);
 		cute_term_depth_printf(&report->term,
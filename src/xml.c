@@ -7,6 +7,8 @@
 
 #include "cons.h"
 #include "suite.h"
+#include "bisect.h"
+#include <inttypes.h>
 #include <langinfo.h>
 #include <string.h>
 #include <stdlib.h>
@@ -167,7 +169,6 @@ cute_xml_report_testcase_details(FILE *                  stdio,
 	struct cute_text_block * blk;
 
 	fprintf(stdio,
-	        ">\n"
 	        "%*s<%s message=\"%s\">\n"
 	        "reason: %s\n",
 	        depth + 4, "", label, run->what,
@@ -187,6 +188,185 @@ cute_xml_report_testcase_details(FILE *                  stdio,
 	cute_xml_report_stdio(stdio, depth + 4, run);
 }
 
+static void
+cute_xml_report_usec(FILE *        stdio,
+                     const char *  name,
+                     unsigned long usec,
+                     int           depth)
+{
+	fprintf(stdio,
+	        "%2$*1$s<property name=\"%3$s\"\n"
+	        "%2$*1$s          value=\"%4$lu.%5$06lu\" />\n",
+	        depth, "",
+	        name,
+	        usec / 1000000UL, usec % 1000000UL);
+}
+
+/*
+ * Report pass / fail counts and duration distribution of iterations run in
+ * repeat mode (see cute_config::repeat).
+ */
+static void
+cute_xml_report_repeat(FILE * stdio, int depth, const struct cute_run * run)
+{
+	const struct cute_repeat * rep = &run->repeat;
+
+	fprintf(stdio,
+	        "%2$*1$s<property name=\"repeat-runs\"\n"
+	        "%2$*1$s          value=\"%3$u\" />\n"
+	        "%2$*1$s<property name=\"repeat-pass\"\n"
+	        "%2$*1$s          value=\"%4$u\" />\n"
+	        "%2$*1$s<property name=\"repeat-fail\"\n"
+	        "%2$*1$s          value=\"%5$u\" />\n",
+	        depth, "",
+	        rep->runs,
+	        rep->pass,
+	        rep->fail);
+
+	cute_xml_report_usec(stdio, "repeat-min", rep->min, depth);
+	cute_xml_report_usec(stdio, "repeat-median", rep->med, depth);
+	cute_xml_report_usec(stdio, "repeat-p95", rep->p95, depth);
+	cute_xml_report_usec(stdio, "repeat-max", rep->max, depth);
+}
+
+static void
+cute_xml_report_span(FILE *                   stdio,
+                     const char *             name,
+                     const struct cute_span * span,
+                     int                      depth)
+{
+	struct timespec diff;
+
+	cute_span_diff(&diff, span);
+
+	fprintf(stdio,
+	        "%2$*1$s<property name=\"%3$s\"\n"
+	        "%2$*1$s          value=\"%4$ld.%5$09ld\" />\n",
+	        depth, "",
+	        name,
+	        diff.tv_sec, diff.tv_nsec);
+}
+
+static void
+cute_xml_report_long(FILE *       stdio,
+                     const char * name,
+                     long         value,
+                     int          depth)
+{
+	fprintf(stdio,
+	        "%2$*1$s<property name=\"%3$s\"\n"
+	        "%2$*1$s          value=\"%4$ld\" />\n",
+	        depth, "",
+	        name,
+	        value);
+}
+
+/*
+ * Report resources consumed by test function. CPU times are given in seconds
+ * and maximum resident set size growth in kilobytes.
+ */
+static void
+cute_xml_report_usage(FILE *                    stdio,
+                      const struct cute_usage * usage,
+                      int                       depth)
+{
+	cute_xml_report_usec(stdio,
+	                     "user-time",
+	                     (unsigned long)usage->utime,
+	                     depth);
+	cute_xml_report_usec(stdio,
+	                     "system-time",
+	                     (unsigned long)usage->stime,
+	                     depth);
+	cute_xml_report_long(stdio, "minor-faults", usage->minflt, depth);
+	cute_xml_report_long(stdio, "major-faults", usage->majflt, depth);
+	cute_xml_report_long(stdio,
+	                     "voluntary-switches",
+	                     usage->nvcsw,
+	                     depth);
+	cute_xml_report_long(stdio,
+	                     "involuntary-switches",
+	                     usage->nivcsw,
+	                     depth);
+	cute_xml_report_long(stdio, "maxrss-growth", usage->maxrss, depth);
+}
+
+static void
+cute_xml_report_perf(FILE *                   stdio,
+                     const struct cute_perf * perf,
+                     int                      depth)
+{
+	unsigned int c;
+
+	for (c = 0; c < CUTE_PERF_NR; c++) {
+		if (perf->mask & (1U << c))
+			fprintf(stdio,
+			        "%2$*1$s<property name=\"perf-%3$s\"\n"
+			        "%2$*1$s          value=\"%4$" PRIu64 "\" />\n",
+			        depth, "",
+			        cute_perf_name(c),
+			        perf->counts[c]);
+	}
+}
+
+static void
+cute_xml_report_heap(FILE *                   stdio,
+                     const struct cute_heap * heap,
+                     int                      depth)
+{
+	if (!heap->tracked)
+		return;
+
+	fprintf(stdio,
+	        "%2$*1$s<property name=\"heap-allocations\"\n"
+	        "%2$*1$s          value=\"%3$lu\" />\n"
+	        "%2$*1$s<property name=\"heap-bytes\"\n"
+	        "%2$*1$s          value=\"%4$lu\" />\n"
+	        "%2$*1$s<property name=\"heap-peak\"\n"
+	        "%2$*1$s          value=\"%5$lu\" />\n"
+	        "%2$*1$s<property name=\"heap-leaks\"\n"
+	        "%2$*1$s          value=\"%6$lu\" />\n",
+	        depth, "",
+	        heap->allocs,
+	        heap->bytes,
+	        heap->peak,
+	        heap->leaks);
+}
+
+/*
+ * Report time spent into each test phase with nanosecond precision, resources
+ * consumed, performance counts and heap allocations, followed by repeat mode
+ * statistics if any.
+ */
+static void
+cute_xml_report_testcase_props(FILE *                  stdio,
+                               int                     depth,
+                               const struct cute_run * run)
+{
+	fprintf(stdio, "%*s<properties>\n", depth, "");
+
+	cute_xml_report_span(stdio,
+	                     "setup-time",
+	                     &run->times.setup,
+	                     depth + 4);
+	cute_xml_report_span(stdio,
+	                     "exec-time",
+	                     &run->times.exec,
+	                     depth + 4);
+	cute_xml_report_span(stdio,
+	                     "teardown-time",
+	                     &run->times.teardown,
+	                     depth + 4);
+	cute_xml_report_usage(stdio, &run->usage, depth + 4);
+	cute_xml_report_perf(stdio, &run->perf, depth + 4);
+	cute_xml_report_heap(stdio, &run->heap, depth + 4);
+
+	if (run->repeat.runs)
+		cute_xml_report_repeat(stdio, depth + 4, run);
+
+	fprintf(stdio, "%*s</properties>\n", depth, "");
+}
+
 static void
 cute_xml_report_testcase(const struct cute_xml_report * report,
                          const struct cute_run *        run)
@@ -197,8 +377,8 @@ cute_xml_report_testcase(const struct cute_xml_report * report,
 	char            str[CUTE_TIME_STRING_SZ];
 	const char *    tstamp;
 
-	cute_diff_tspec(&diff, &run->begin, &run->end);
-	tstamp = cute_time_string(str, &run->begin);
+	cute_span_diff(&diff, &run->times.exec);
+	tstamp = cute_time_string(str, &run->stamp);
 
 	switch (run->issue) {
 	case CUTE_PASS_ISSUE:
@@ -218,6 +398,7 @@ cute_xml_report_testcase(const struct cute_xml_report * report,
 		break;
 
 	case CUTE_OFF_ISSUE:
+	case CUTE_CUT_ISSUE:
 		status = "disabled";
 		break;
 
@@ -254,21 +435,26 @@ cute_xml_report_testcase(const struct cute_xml_report * report,
 
 	switch (run->issue) {
 	case CUTE_PASS_ISSUE:
-		if (cute_iodir_is_block_busy(&run->ioout) ||
-		    cute_iodir_is_block_busy(&run->ioerr)) {
+		if (!run->cached) {
 			fputs(">\n", report->stdio);
+			cute_xml_report_testcase_props(report->stdio,
+			                               depth + 4,
+			                               run);
 			cute_xml_report_stdio(report->stdio, depth + 4, run);
 			break;
 		}
 		__attribute__ ((fallthrough));
 
 	case CUTE_OFF_ISSUE:
+	case CUTE_CUT_ISSUE:
 		fputs(" />\n", report->stdio);
 		return;
 
 	case CUTE_SKIP_ISSUE:
 	case CUTE_FAIL_ISSUE:
 	case CUTE_EXCP_ISSUE:
+		fputs(">\n", report->stdio);
+		cute_xml_report_testcase_props(report->stdio, depth + 4, run);
 		cute_xml_report_testcase_details(report->stdio,
 		                                 depth,
 		                                 status,
@@ -293,6 +479,36 @@ cute_xml_report_build_id(const struct cute_xml_report * report, int depth)
 		        cute_build_id);
 }
 
+static void
+cute_xml_report_count(const struct cute_xml_report * report,
+                      const char *                   name,
+                      unsigned int                   count,
+                      int                            depth)
+{
+	if (count)
+		fprintf(report->stdio,
+		        "%2$*1$s<property name=\"%3$s\"\n"
+		        "%2$*1$s          value=\"%4$u\" />\n",
+		        depth, "",
+		        name,
+		        count);
+}
+
+static void
+cute_xml_report_name(const struct cute_xml_report * report,
+                     const char *                   name,
+                     const struct cute_run *        run,
+                     int                            depth)
+{
+	if (run)
+		fprintf(report->stdio,
+		        "%2$*1$s<property name=\"%3$s\"\n"
+		        "%2$*1$s          value=\"%4$s\" />\n",
+		        depth, "",
+		        name,
+		        run->name);
+}
+
 static void
 cute_xml_report_prop(const struct cute_xml_report * report,
                      const char *                   name,
@@ -324,7 +540,7 @@ cute_xml_report_begin_testsuite(const struct cute_xml_report * report,
 	char            str[CUTE_TIME_STRING_SZ];
 	const char *    tstamp;
 
-	cute_diff_tspec(&diff, &suite->super.begin, &suite->super.end);
+	cute_span_diff(&diff, &suite->super.times.exec);
 
 	fprintf(report->stdio,
 	        "%2$*1$s<testsuite name=\"%3$s\"\n"
@@ -358,7 +574,7 @@ cute_xml_report_begin_testsuite(const struct cute_xml_report * report,
 		        depth, "",
 		        suite->super.id);
 
-	tstamp = cute_time_string(str, &suite->super.begin);
+	tstamp = cute_time_string(str, &suite->super.stamp);
 	if (tstamp)
 		fprintf(report->stdio,
 		        "%*s           timestamp=\"%s+00:00\"\n",
@@ -377,6 +593,34 @@ cute_xml_report_begin_testsuite(const struct cute_xml_report * report,
 	if (!depth) {
 		fprintf(report->stdio, "%*s<properties>\n", depth + 4, "");
 		cute_xml_report_build_id(report, depth + 8);
+		/*
+		 * Tests not run because of cute_config::fail_fast are
+		 * reported as disabled and tests found into result cache as
+		 * passed: record these so that such runs may be told apart.
+		 */
+		cute_xml_report_count(report,
+		                      "cut-short",
+		                      suite->sums.cut,
+		                      depth + 8);
+		cute_xml_report_count(report,
+		                      "cached",
+		                      suite->sums.cached,
+		                      depth + 8);
+		if (cute_the_config->shuffle)
+			fprintf(report->stdio,
+			        "%2$*1$s<property name=\"shuffle-seed\"\n"
+			        "%2$*1$s          value=\"%3$u\" />\n",
+			        depth + 8, "",
+			        cute_the_config->seed);
+		cute_xml_report_name(report,
+		                     "order-culprit",
+		                     cute_bisect_culprit,
+		                     depth + 8);
+		cute_xml_report_name(report,
+		                     "order-victim",
+		                     cute_bisect_victim,
+		                     depth + 8);
+		cute_load_elf_props();
 		cute_xml_report_prop(report,
 		                     "build-tool",
 		                     &cute_build_tool,
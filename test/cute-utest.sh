@@ -27,6 +27,15 @@ BEGIN {
 	gsub("0x[0-9a-fA-F]+", "0x????????????????", $0);
 }
 
+/^reason: descriptors left open:/ {
+	gsub("[0-9]+ -> ", "? -> ", $0);
+}
+
+/^  [a-z_]+_(ms|faults|switches|kb): [0-9.]+$/ ||
+/^    (instructions|cycles|cache-misses|branch-misses|task-clock|page-faults): / {
+	gsub("[0-9.]+$", "?", $0);
+}
+
 /^NAME[[:blank:]]+[#[:blank:](.A-Z]+/ {
 	stat=1
 }
@@ -69,47 +78,50 @@ run_testcase()
 {
 	local case="$1"
 	local exp=$2
+	local opts="$3"
+	local ref="${4:-$case}"
+	local tag=$(echo "$case$opts" | tr '/ ' '__')
 	local stat=0
 
 	if ! [ -f $libexecdir/$case ]; then
-		fail "$case" "missing testcase binary."
+		fail "$tag" "missing testcase binary."
 		return 1
 	fi
 
-	trap "clean_testcase \"$case\"" HUP INT QUIT TERM
+	trap "clean_testcase \"$tag\"" HUP INT QUIT TERM
 
 	if ! awk "$adjust" \
-	          $testsrcdir/$case-outref.txt \
-	          > $testdir/$case-outref.txt; then
-		fail "$case" "cannot generate output reference."
+	          $testsrcdir/$ref-outref.txt \
+	          > $testdir/$tag-outref.txt; then
+		fail "$tag" "cannot generate output reference."
 		return 1
 	fi
 	
-	if ! $libexecdir/$case run \
-	     >$testdir/$case-stdout.txt.tmp 2>/dev/null; then
+	if ! $libexecdir/$case $opts run \
+	     >$testdir/$tag-stdout.txt.tmp 2>/dev/null; then
 		stat=1
 	fi
 	if [ $stat -ne $exp ]; then
-	        mv $testdir/$case-stdout.txt.tmp $testdir/$case-stdout.txt
-		fail "$case" "test case exited with unexpected status."
+	        mv $testdir/$tag-stdout.txt.tmp $testdir/$tag-stdout.txt
+		fail "$tag" "test case exited with unexpected status."
 		return 1
 	fi
 
-	if ! awk "$adjust" $testdir/$case-stdout.txt.tmp \
-	     > $testdir/$case-stdout.txt; then
-		fail "$case" "cannot generate test case output."
+	if ! awk "$adjust" $testdir/$tag-stdout.txt.tmp \
+	     > $testdir/$tag-stdout.txt; then
+		fail "$tag" "cannot generate test case output."
 		return 1
 	fi
 	
-	if ! cmp -s $testdir/$case-stdout.txt $testdir/$case-outref.txt; then
-		fail "$case" "test case output differ from reference output."
-		diff $testdir/$case-outref.txt $testdir/$case-stdout.txt
+	if ! cmp -s $testdir/$tag-stdout.txt $testdir/$tag-outref.txt; then
+		fail "$tag" "test case output differ from reference output."
+		diff $testdir/$tag-outref.txt $testdir/$tag-stdout.txt
 		return 1
 	else
-		pass "$case"
+		pass "$tag"
 	fi
 
-	clean_testcase "$case"
+	clean_testcase "$tag"
 	trap - HUP INT QUIT TERM
 
 	return 0
@@ -128,6 +140,11 @@ run_testcase "simple-teardown-fail-utest" 1 || ret=1
 run_testcase "simple-fixture-fail-utest" 1 || ret=1
 run_testcase "simple-tmout-utest" 1 || ret=1
 run_testcase "simple-iodir-utest" 1 || ret=1
+run_testcase "simple-thread-utest" 1 || ret=1
+run_testcase "simple-snapshot-utest" 1 || ret=1
+run_testcase "simple-heap-utest" 0 || ret=1
+run_testcase "simple-leak-utest" 0 || ret=1
+run_testcase "simple-order-utest" 0 || ret=1
 run_testcase "check-bool-utest" 1 || ret=1
 run_testcase "check-sint-utest" 1 || ret=1
 run_testcase "check-uint-utest" 1 || ret=1
@@ -147,6 +164,106 @@ run_testcase "expect-ptr-utest" 1 || ret=1
 run_testcase "expect-mem-utest" 1 || ret=1
 run_testcase "expect-assert-utest" 1 || ret=1
 
+# Parallel runs must report exactly as sequential ones do.
+run_testcase "simple-exec-fail-utest" 1 -j4 || ret=1
+run_testcase "simple-exec-error-utest" 1 -j4 || ret=1
+run_testcase "simple-setup-error-utest" 1 -j4 || ret=1
+run_testcase "simple-teardown-fail-utest" 1 -j4 || ret=1
+run_testcase "simple-tmout-utest" 1 -j4 || ret=1
+run_testcase "simple-iodir-utest" 1 -j4 || ret=1
+run_testcase "check-str-utest" 1 -j4 || ret=1
+run_testcase "expect-bool-utest" 1 -j4 || ret=1
+run_testcase "expect-assert-utest" 1 -j4 || ret=1
+run_testcase "simple-thread-utest" 1 -j4 || ret=1
+
+# Threaded suites must report exactly as sequential ones do.
+run_testcase "simple-thread-utest" 1 -T4 || ret=1
+
+# Snapshot runs must report exactly as sequential ones do.
+run_testcase "simple-snapshot-utest" 1 -S || ret=1
+run_testcase "simple-tmout-utest" 1 -S || ret=1
+
+# Longest first dispatching must report exactly as sequential runs do.
+$libexecdir/simple-thread-utest -s -x$testdir/simple-thread-hist.xml run \
+	>/dev/null 2>&1 || true
+run_testcase "simple-thread-utest" 1 "-j4 -P$testdir/simple-thread-hist.xml" || \
+	ret=1
+run_testcase "simple-thread-utest" 1 "-T4 -P$testdir/simple-thread-hist.xml" || \
+	ret=1
+rm -f $testdir/simple-thread-hist.xml
+
+# Shards must be disjoint and cover the whole hierarchy.
+run_testcase "simple-snapshot-utest" 1 -H1/2 "simple-snapshot-utest-shard1" || \
+	ret=1
+run_testcase "simple-snapshot-utest" 1 -H2/2 "simple-snapshot-utest-shard2" || \
+	ret=1
+
+# Selecting a suite by full name must run its descendants only.
+run_testcase "simple-snapshot-utest" 1 \
+	"-Nsimple_snapshot_suite::simple_snapshot_fail_suite" \
+	"simple-snapshot-utest-name" || ret=1
+
+# Include and exclude selectors must select matching nodes and their
+# descendants.
+run_testcase "simple-snapshot-utest" 1 \
+	"-Isimple_snapshot_suite::*fail* -Isimple_snapshot_suite::simple_snapshot_pass0_test -Xsimple_snapshot_suite::simple_snapshot_fail_suite" \
+	"simple-snapshot-utest-select" || ret=1
+
+# Re-running failures must select tests failed into previous JUnit or TAP
+# report only.
+$libexecdir/simple-thread-utest -s -x$testdir/simple-thread-rerun.xml \
+	-a$testdir/simple-thread-rerun.tap run >/dev/null 2>&1 || true
+run_testcase "simple-thread-utest" 1 "-R$testdir/simple-thread-rerun.xml" \
+	"simple-thread-utest-rerun" || ret=1
+run_testcase "simple-thread-utest" 1 "-R$testdir/simple-thread-rerun.tap" \
+	"simple-thread-utest-rerun" || ret=1
+rm -f $testdir/simple-thread-rerun.xml $testdir/simple-thread-rerun.tap
+
+# Tests passed by a previous run of the same build must be reported as cached.
+rm -rf $testdir/cache
+$libexecdir/simple-thread-utest -s -C$testdir/cache run >/dev/null 2>&1 || true
+run_testcase "simple-thread-utest" 1 "-C$testdir/cache" \
+	"simple-thread-utest-cache" || ret=1
+rm -rf $testdir/cache
+
+# Tests left once enough of them failed must be reported as cut short.
+run_testcase "simple-thread-utest" 1 -f2 "simple-thread-utest-failfast" || ret=1
+
+# Repeated tests must report iteration counts, stopping at first failure.
+run_testcase "simple-thread-utest" 1 "-r3 -u" "simple-thread-utest-repeat" || \
+	ret=1
+
+# Shuffled run must fail and bisection find the pair of tests reproducing it.
+run_testcase "simple-order-utest" 1 "-O2 -B" "simple-order-utest-bisect" || \
+	ret=1
+
+# Busy looping tests must be cut short once their CPU time budget is exhausted.
+run_testcase "simple-tmout-utest" 1 -c100 "simple-tmout-utest-cpu" || ret=1
+
+# Sampling performance counters must not alter test outcomes.
+run_testcase "simple-exec-pass-utest" 0 "-Einstructions,task-clock" || ret=1
+run_testcase "simple-thread-utest" 1 "-T4 -Ecycles,page-faults" || ret=1
+
+# Tests leaving heap blocks allocated behind must fail when tracking heap.
+run_testcase "simple-heap-utest" 1 -m "simple-heap-utest-leak" || ret=1
+run_testcase "simple-heap-utest" 1 "-j2 -m" "simple-heap-utest-leak" || ret=1
+
+# TAP report must carry per stage timings, resource usage, performance
+# counters and heap statistics of each test.
+if $libexecdir/simple-exec-pass-utest -Etask-clock run 2>&1 >/dev/null | \
+   grep -q "cannot open performance counters"; then
+	printf "%.${cols}s %s\n" "simple-heap-utest-tap $hrule" "skip" >&2
+else
+	run_testcase "simple-heap-utest" 1 "-m -Etask-clock -a" \
+		"simple-heap-utest-tap" || ret=1
+fi
+
+# Tests leaving descriptors open or threads running behind must fail.
+run_testcase "simple-leak-utest" 1 -L "simple-leak-utest-leak" || ret=1
+run_testcase "simple-leak-utest" 1 "-j2 -L" "simple-leak-utest-leak" || ret=1
+# Concurrent threaded suite tests are not checked.
+run_testcase "simple-thread-utest" 1 "-T4 -L" || ret=1
+
 rmdir --ignore-fail-on-non-empty ${testdir}
 
 exit $ret
@@ -76,6 +76,36 @@ simple-iodir-utest-cflags          := $(test-cflags)
 simple-iodir-utest-ldflags         := $(test-ldflags) -lcute
 simple-iodir-utest-path            := $(LIBEXECDIR)/cute/simple-iodir-utest
 
+checkbins                          += simple-thread-utest
+simple-thread-utest-objs           := simple_thread.o $(config-obj)
+simple-thread-utest-cflags         := $(test-cflags)
+simple-thread-utest-ldflags        := $(test-ldflags) -lcute
+simple-thread-utest-path           := $(LIBEXECDIR)/cute/simple-thread-utest
+
+checkbins                          += simple-snapshot-utest
+simple-snapshot-utest-objs         := simple_snapshot.o $(config-obj)
+simple-snapshot-utest-cflags       := $(test-cflags)
+simple-snapshot-utest-ldflags      := $(test-ldflags) -lcute
+simple-snapshot-utest-path         := $(LIBEXECDIR)/cute/simple-snapshot-utest
+
+checkbins                          += simple-heap-utest
+simple-heap-utest-objs             := simple_heap.o $(config-obj)
+simple-heap-utest-cflags           := $(test-cflags)
+simple-heap-utest-ldflags          := $(test-ldflags) -lcute -lcute-heap
+simple-heap-utest-path             := $(LIBEXECDIR)/cute/simple-heap-utest
+
+checkbins                          += simple-leak-utest
+simple-leak-utest-objs             := simple_leak.o $(config-obj)
+simple-leak-utest-cflags           := $(test-cflags)
+simple-leak-utest-ldflags          := $(test-ldflags) -lcute
+simple-leak-utest-path             := $(LIBEXECDIR)/cute/simple-leak-utest
+
+checkbins                          += simple-order-utest
+simple-order-utest-objs            := simple_order.o $(config-obj)
+simple-order-utest-cflags          := $(test-cflags)
+simple-order-utest-ldflags         := $(test-ldflags) -lcute
+simple-order-utest-path            := $(LIBEXECDIR)/cute/simple-order-utest
+
 checkbins                          += check-bool-utest
 check-bool-utest-objs              := check_bool.o $(config-obj)
 check-bool-utest-cflags            := $(test-cflags)
@@ -195,8 +225,23 @@ clean-check: _clean-check
 _clean-check:
 	$(call rm_recipe,$(BUILDDIR)/cute-utest.sh)
 
+# Output references of testcases run with options altering their output.
+checkrefs := simple-snapshot-utest-shard1 \
+             simple-snapshot-utest-shard2 \
+             simple-snapshot-utest-name \
+             simple-snapshot-utest-select \
+             simple-thread-utest-failfast \
+             simple-thread-utest-rerun \
+             simple-thread-utest-cache \
+             simple-thread-utest-repeat \
+             simple-order-utest-bisect \
+             simple-tmout-utest-cpu \
+             simple-heap-utest-leak \
+             simple-heap-utest-tap \
+             simple-leak-utest-leak
+
 _outrefs := $(foreach b, \
-                      $(checkbins), \
+                      $(checkbins) $(checkrefs), \
                       $(DESTDIR)$(LIBEXECDIR)/cute/$(b)-outref.txt)
 
 install-check install-strip-check: $(DESTDIR)$(BINDIR)/cute-utest.sh $(_outrefs)
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#include "cute/cute.h"
+#include "cute/check.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+/* Prevent compiler from optimizing allocation / release pairs out. */
+static void * volatile simple_heap_blocks[7];
+
+/* Process-lifetime cache allocated on purpose by the code under test. */
+static void * simple_heap_cache;
+
+static void *
+simple_heap_release(void * arg)
+{
+	free(arg);
+
+	return NULL;
+}
+
+static void *
+simple_heap_alloc(void * arg)
+{
+	simple_heap_blocks[6] = malloc(48);
+
+	return arg;
+}
+
+/*
+ * Get glibc to allocate resources it keeps for the lifetime of the process
+ * before tests are tracked: timezone data and a cached thread stack.
+ */
+static void __attribute__((constructor))
+simple_heap_warmup(void)
+{
+	pthread_t thr;
+
+	tzset();
+	if (!pthread_create(&thr, NULL, simple_heap_release, NULL))
+		pthread_join(thr, NULL);
+}
+
+static void
+simple_heap_setup()
+{
+	simple_heap_blocks[0] = malloc(32);
+}
+
+static void
+simple_heap_teardown()
+{
+	free(simple_heap_blocks[0]);
+}
+
+CUTE_TEST(simple_heap_pass_test)
+{
+	void * ptr = NULL;
+
+	simple_heap_blocks[0] = malloc(16);
+	simple_heap_blocks[1] = calloc(4, 8);
+	simple_heap_blocks[1] = realloc(simple_heap_blocks[1], 256);
+	cute_check_assert(!posix_memalign(&ptr, 64, 128));
+	simple_heap_blocks[2] = ptr;
+	simple_heap_blocks[4] = aligned_alloc(64, 192);
+	simple_heap_blocks[5] = valloc(100);
+	cute_check_assert(aligned_alloc(48, 96) == NULL);
+
+	free(simple_heap_blocks[5]);
+	free(simple_heap_blocks[4]);
+	free(simple_heap_blocks[2]);
+	free(simple_heap_blocks[1]);
+	free(simple_heap_blocks[0]);
+}
+
+CUTE_TEST_STATIC(simple_heap_fixture_test,
+                 simple_heap_setup,
+                 simple_heap_teardown,
+                 CUTE_DFLT_TMOUT)
+{
+	cute_check_assert(simple_heap_blocks[0] != NULL);
+}
+
+CUTE_TEST(simple_heap_print_test)
+{
+	printf("simple_heap_print_test\n");
+}
+
+CUTE_TEST(simple_heap_time_test)
+{
+	time_t    now = time(NULL);
+	struct tm tm;
+
+	cute_check_assert(localtime_r(&now, &tm) != NULL);
+}
+
+CUTE_TEST(simple_heap_ignore_test)
+{
+	if (!simple_heap_cache)
+		simple_heap_cache = malloc(128);
+	cute_check_assert(simple_heap_cache != NULL);
+
+	cute_heap_ignore(simple_heap_cache);
+}
+
+CUTE_TEST(simple_heap_thread_test)
+{
+	void *    ptr = malloc(32);
+	pthread_t thr;
+
+	cute_check_assert(ptr != NULL);
+	cute_check_assert(!pthread_create(&thr, NULL, simple_heap_release, ptr));
+	cute_check_assert(!pthread_join(thr, NULL));
+}
+
+CUTE_TEST(simple_heap_thread_leak_test)
+{
+	pthread_t thr;
+
+	cute_check_assert(!pthread_create(&thr, NULL, simple_heap_alloc, NULL));
+	cute_check_assert(!pthread_join(thr, NULL));
+	cute_check_assert(simple_heap_blocks[6] != NULL);
+}
+
+CUTE_TEST(simple_heap_leak_test)
+{
+	simple_heap_blocks[3] = malloc(64);
+	cute_check_assert(simple_heap_blocks[3] != NULL);
+}
+
+CUTE_GROUP(simple_heap_tests) = {
+	CUTE_REF(simple_heap_pass_test),
+	CUTE_REF(simple_heap_fixture_test),
+	CUTE_REF(simple_heap_print_test),
+	CUTE_REF(simple_heap_time_test),
+	CUTE_REF(simple_heap_ignore_test),
+	CUTE_REF(simple_heap_thread_test),
+	CUTE_REF(simple_heap_thread_leak_test),
+	CUTE_REF(simple_heap_leak_test)
+};
+
+CUTE_SUITE(simple_heap_suite, simple_heap_tests);
+
+CUTE_MAIN(simple_heap_suite, "CUTe", NULL)
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#include "cute/cute.h"
+#include "cute/check.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+static int simple_leak_fd = -1;
+
+static void *
+simple_leak_wait(void * arg)
+{
+	/* Block till process exits. */
+	while (true)
+		pause();
+
+	return arg;
+}
+
+static void *
+simple_leak_noop(void * arg)
+{
+	return arg;
+}
+
+static void
+simple_leak_setup()
+{
+	simple_leak_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+static void
+simple_leak_teardown()
+{
+	close(simple_leak_fd);
+}
+
+CUTE_TEST(simple_leak_pass_test)
+{
+	int       fd;
+	pthread_t thr;
+
+	fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	cute_check_assert(fd >= 0);
+	close(fd);
+
+	cute_check_assert(!pthread_create(&thr, NULL, simple_leak_noop, NULL));
+	cute_check_assert(!pthread_join(thr, NULL));
+}
+
+CUTE_TEST_STATIC(simple_leak_fixture_test,
+                 simple_leak_setup,
+                 simple_leak_teardown,
+                 CUTE_DFLT_TMOUT)
+{
+	cute_check_assert(simple_leak_fd >= 0);
+}
+
+CUTE_TEST(simple_leak_fd_test)
+{
+	cute_check_assert(open("/dev/null", O_RDONLY | O_CLOEXEC) >= 0);
+}
+
+CUTE_TEST(simple_leak_thread_test)
+{
+	pthread_t thr;
+
+	cute_check_assert(!pthread_create(&thr, NULL, simple_leak_wait, NULL));
+	cute_check_assert(!pthread_detach(thr));
+}
+
+CUTE_GROUP(simple_leak_tests) = {
+	CUTE_REF(simple_leak_pass_test),
+	CUTE_REF(simple_leak_fixture_test),
+	CUTE_REF(simple_leak_fd_test),
+	CUTE_REF(simple_leak_thread_test)
+};
+
+CUTE_SUITE(simple_leak_suite, simple_leak_tests);
+
+CUTE_MAIN(simple_leak_suite, "CUTe", NULL)
@@ -0,0 +1,60 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#include "cute/cute.h"
+#include "cute/check.h"
+
+static int simple_order_value;
+
+CUTE_TEST(simple_order_pass0_test)
+{
+	cute_check_sint(simple_order_value, greater_equal, 0);
+}
+
+/* Fails only when run after simple_order_leak_test. */
+CUTE_TEST(simple_order_victim_test)
+{
+	cute_check_sint(simple_order_value, equal, 0);
+}
+
+CUTE_TEST(simple_order_pass1_test)
+{
+	cute_check_sint(simple_order_value, greater_equal, 0);
+}
+
+/* Leaves state behind. */
+CUTE_TEST(simple_order_leak_test)
+{
+	simple_order_value = 1;
+}
+
+CUTE_TEST(simple_order_pass2_test)
+{
+	cute_check_sint(simple_order_value, greater_equal, 0);
+}
+
+CUTE_TEST(simple_order_pass3_test)
+{
+	cute_check_sint(simple_order_value, greater_equal, 0);
+}
+
+CUTE_GROUP(simple_order_tests) = {
+	CUTE_REF(simple_order_pass0_test),
+	CUTE_REF(simple_order_victim_test),
+	CUTE_REF(simple_order_pass1_test),
+	CUTE_REF(simple_order_leak_test),
+	CUTE_REF(simple_order_pass2_test),
+	CUTE_REF(simple_order_pass3_test)
+};
+
+CUTE_SUITE_STATIC(simple_order_suite,
+                  simple_order_tests,
+                  CUTE_NULL_SETUP,
+                  CUTE_NULL_TEARDOWN,
+                  CUTE_DFLT_TMOUT);
+
+CUTE_MAIN(simple_order_suite, "CUTe", NULL)
@@ -0,0 +1,101 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#include "cute/cute.h"
+#include "cute/check.h"
+
+static int simple_snapshot_value;
+
+static void
+simple_snapshot_setup(void)
+{
+	simple_snapshot_value = 5;
+}
+
+static void
+simple_snapshot_teardown(void)
+{
+	cute_check_sint(simple_snapshot_value, greater_equal, 0);
+	simple_snapshot_value = 0;
+}
+
+static void
+simple_snapshot_fail_setup(void)
+{
+	cute_fail("explicit setup failure");
+}
+
+/* Tests below must all start from the very same post-setup state. */
+CUTE_TEST(simple_snapshot_pass0_test)
+{
+	cute_check_sint(simple_snapshot_value, equal, 5);
+	simple_snapshot_value = 6;
+}
+
+CUTE_TEST(simple_snapshot_pass1_test)
+{
+	cute_check_sint(simple_snapshot_value, equal, 5);
+	simple_snapshot_value = 7;
+}
+
+CUTE_TEST(simple_snapshot_fail_test)
+{
+	cute_check_sint(simple_snapshot_value, equal, 0);
+}
+
+CUTE_TEST(simple_snapshot_teardown_fail_test)
+{
+	simple_snapshot_value = -1;
+}
+
+CUTE_TEST(simple_snapshot_segv_test)
+{
+	int * var = NULL;
+
+	*var = 2;
+}
+
+CUTE_TEST_STATIC(simple_snapshot_own_setup_test,
+                 CUTE_NULL_SETUP,
+                 CUTE_INHR_TEARDOWN,
+                 CUTE_INHR_TMOUT)
+{
+	cute_check_sint(simple_snapshot_value, equal, 0);
+}
+
+CUTE_TEST(simple_snapshot_setup_fail_test)
+{
+	cute_check_sint(simple_snapshot_value, equal, 0);
+}
+
+CUTE_GROUP(simple_snapshot_fail_tests) = {
+	CUTE_REF(simple_snapshot_setup_fail_test)
+};
+
+CUTE_SUITE_STATIC(simple_snapshot_fail_suite,
+                  simple_snapshot_fail_tests,
+                  simple_snapshot_fail_setup,
+                  CUTE_NULL_TEARDOWN,
+                  CUTE_DFLT_TMOUT);
+
+CUTE_GROUP(simple_snapshot_tests) = {
+	CUTE_REF(simple_snapshot_pass0_test),
+	CUTE_REF(simple_snapshot_fail_test),
+	CUTE_REF(simple_snapshot_own_setup_test),
+	CUTE_REF(simple_snapshot_fail_suite),
+	CUTE_REF(simple_snapshot_pass1_test),
+	CUTE_REF(simple_snapshot_teardown_fail_test),
+	CUTE_REF(simple_snapshot_segv_test)
+};
+
+CUTE_SUITE_STATIC(simple_snapshot_suite,
+                  simple_snapshot_tests,
+                  simple_snapshot_setup,
+                  simple_snapshot_teardown,
+                  CUTE_DFLT_TMOUT);
+
+CUTE_MAIN(simple_snapshot_suite, "CUTe", NULL)
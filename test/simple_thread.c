@@ -0,0 +1,78 @@
+/******************************************************************************
+ * SPDX-License-Identifier: LGPL-3.0-only
+ *
+ * This file is part of CUTe.
+ * Copyright (C) 2023 Grégor Boirie <gregor.boirie@free.fr>
+ ******************************************************************************/
+
+#include "cute/cute.h"
+#include "cute/check.h"
+#include "cute/expect.h"
+#include <unistd.h>
+
+static void
+simple_thread_callee(int value)
+{
+	cute_mock_sint_parm(value);
+}
+
+CUTE_TEST(simple_thread_pass_test)
+{
+	usleep(1000000U / 4);
+}
+
+CUTE_TEST(simple_thread_fail_test)
+{
+	usleep(1000000U / 4);
+	cute_check_sint(1, equal, 0);
+}
+
+CUTE_TEST(simple_thread_segv_test)
+{
+	volatile int * var = NULL;
+
+	usleep(1000000U / 4);
+	*var = 2;
+}
+
+CUTE_TEST(simple_thread_tmout_pass_test)
+{
+	usleep(1000000U / 2);
+}
+
+CUTE_TEST(simple_thread_tmout_fail_test)
+{
+	usleep(2000000U);
+}
+
+CUTE_TEST(simple_thread_expect_pass_test)
+{
+	cute_expect_sint_parm(simple_thread_callee, value, equal, 1);
+	usleep(1000000U / 4);
+	simple_thread_callee(1);
+}
+
+CUTE_TEST(simple_thread_expect_fail_test)
+{
+	cute_expect_sint_parm(simple_thread_callee, value, equal, 1);
+	usleep(1000000U / 4);
+	simple_thread_callee(2);
+}
+
+CUTE_GROUP(simple_thread_tests) = {
+	CUTE_REF(simple_thread_pass_test),
+	CUTE_REF(simple_thread_fail_test),
+	CUTE_REF(simple_thread_segv_test),
+	CUTE_REF(simple_thread_tmout_pass_test),
+	CUTE_REF(simple_thread_tmout_fail_test),
+	CUTE_REF(simple_thread_expect_pass_test),
+	CUTE_REF(simple_thread_expect_fail_test)
+};
+
+CUTE_THREAD_SUITE_STATIC(simple_thread_suite,
+                         simple_thread_tests,
+                         CUTE_NULL_SETUP,
+                         CUTE_NULL_TEARDOWN,
+                         1U);
+
+CUTE_MAIN(simple_thread_suite, "CUTe", NULL)
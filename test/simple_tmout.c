@@ -50,6 +50,33 @@ CUTE_TEST_STATIC(simple_tmout_inhr_fail_test,
 	usleep(2500000U);
 }
 
+CUTE_TEST_STATIC(simple_tmout_msec_pass_test,
+                 CUTE_NULL_SETUP,
+                 CUTE_NULL_TEARDOWN,
+                 CUTE_MSEC_TMOUT(200U))
+{
+	usleep(100000U);
+}
+
+CUTE_TEST_STATIC(simple_tmout_msec_fail_test,
+                 CUTE_NULL_SETUP,
+                 CUTE_NULL_TEARDOWN,
+                 CUTE_MSEC_TMOUT(200U))
+{
+	usleep(400000U);
+}
+
+CUTE_TEST_STATIC(simple_tmout_busy_fail_test,
+                 CUTE_NULL_SETUP,
+                 CUTE_NULL_TEARDOWN,
+                 CUTE_MSEC_TMOUT(500U))
+{
+	volatile unsigned long cnt = 0;
+
+	while (true)
+		cnt++;
+}
+
 CUTE_GROUP(simple_tmout_tests) = {
 	CUTE_REF(simple_tmout_dflt_pass_test),
 	CUTE_REF(simple_tmout_dflt_fail_test),
@@ -57,6 +84,9 @@ CUTE_GROUP(simple_tmout_tests) = {
 	CUTE_REF(simple_tmout_explicit_fail_test),
 	CUTE_REF(simple_tmout_inhr_pass_test),
 	CUTE_REF(simple_tmout_inhr_fail_test),
+	CUTE_REF(simple_tmout_msec_pass_test),
+	CUTE_REF(simple_tmout_msec_fail_test),
+	CUTE_REF(simple_tmout_busy_fail_test),
 };
 
 CUTE_SUITE_STATIC(simple_tmout_suite,